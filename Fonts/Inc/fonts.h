@@ -13,11 +13,16 @@
 
 #include "main.h"
 
+/* --- The 10x14 font takes 2304 bytes of flash, without it the OLED prints 5x7 --- */
+// #define FONT_DOT_10X14
+
 typedef uint8_t font_dot_5x7_t[6];
 typedef uint8_t font_dot_10x14_t[24];
 
-const font_dot_5x7_t font_dot_5x7[96];
-const font_dot_10x14_t font_dot_10x14[96];
+extern const font_dot_5x7_t font_dot_5x7[96];
+#if defined(FONT_DOT_10X14)
+  extern const font_dot_10x14_t font_dot_10x14[96];
+#endif
 
 
 #endif /* FONTS_H_ */
\ No newline at end of file
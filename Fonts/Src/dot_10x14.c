@@ -10,6 +10,7 @@
 
 #include "fonts.h"
 
+#if defined(FONT_DOT_10X14)
 
 const font_dot_10x14_t font_dot_10x14[96] PROGMEM = {
   {
@@ -686,3 +687,5 @@ const font_dot_10x14_t font_dot_10x14[96] PROGMEM = {
     0x00, 0x00, 0x00, 0x00
   }
 };
+
+#endif /* FONT_DOT_10X14 */
@@ -0,0 +1,45 @@
+/*
+ * Filename: interrupt.h
+ * Description: Host build interrupt vectors, ISR bodies are plain functions
+ *              invoked by the simulated clock.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_INTERRUPT_H_
+#define HOST_INTERRUPT_H_
+
+
+#include <avr/io.h>
+
+
+/* Vectors, numbered as in the ATTiny85 table */
+#define INT0_vect         __vector_1
+#define PCINT0_vect       __vector_2
+#define TIMER1_COMPA_vect __vector_3
+#define TIMER1_OVF_vect   __vector_4
+#define TIMER0_OVF_vect   __vector_5
+#define EE_RDY_vect       __vector_6
+#define ANA_COMP_vect     __vector_7
+#define ADC_vect          __vector_8
+#define TIMER1_COMPB_vect __vector_9
+#define TIMER0_COMPA_vect __vector_10
+#define TIMER0_COMPB_vect __vector_11
+#define WDT_vect          __vector_12
+#define USI_START_vect    __vector_13
+#define USI_OVF_vect      __vector_14
+
+#define ISR_BLOCK
+#define ISR_NOBLOCK
+#define ISR_NAKED
+
+#define ISR(vector, ...)  void vector(void); void vector(void)
+
+#define sei()             Host_Sei()
+#define cli()             Host_Cli()
+#define reti()            return
+
+
+#endif /* HOST_INTERRUPT_H_ */
@@ -0,0 +1,179 @@
+/*
+ * Filename: io.h
+ * Description: Host build ATTiny85 register map. Every register access goes
+ *              through Host_Reg(), which settles the previous write and
+ *              advances the simulated clock by one cycle.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_IO_H_
+#define HOST_IO_H_
+
+
+#include <stdint.h>
+#include "host.h"
+
+
+#define _BV(bit)  (1 << (bit))
+
+#define _HOST_SFR8(r)   (*Host_Reg(r))
+#define _HOST_SFR16(r)  (*(volatile uint16_t*)Host_Reg(r))
+
+
+/* Registers */
+#define PORTB     _HOST_SFR8(HR_PORTB)
+#define DDRB      _HOST_SFR8(HR_DDRB)
+#define PINB      _HOST_SFR8(HR_PINB)
+#define USIDR     _HOST_SFR8(HR_USIDR)
+#define USISR     _HOST_SFR8(HR_USISR)
+#define USICR     _HOST_SFR8(HR_USICR)
+#define USIBR     _HOST_SFR8(HR_USIBR)
+#define EECR      _HOST_SFR8(HR_EECR)
+#define EEDR      _HOST_SFR8(HR_EEDR)
+#define EEAR      _HOST_SFR16(HR_EEARL)
+#define EEARL     _HOST_SFR8(HR_EEARL)
+#define EEARH     _HOST_SFR8(HR_EEARH)
+#define TCNT0     _HOST_SFR8(HR_TCNT0)
+#define TCCR0A    _HOST_SFR8(HR_TCCR0A)
+#define TCCR0B    _HOST_SFR8(HR_TCCR0B)
+#define OCR0A     _HOST_SFR8(HR_OCR0A)
+#define OCR0B     _HOST_SFR8(HR_OCR0B)
+#define TIMSK     _HOST_SFR8(HR_TIMSK)
+#define TIFR      _HOST_SFR8(HR_TIFR)
+#define WDTCR     _HOST_SFR8(HR_WDTCR)
+#define MCUSR     _HOST_SFR8(HR_MCUSR)
+#define MCUCR     _HOST_SFR8(HR_MCUCR)
+#define ACSR      _HOST_SFR8(HR_ACSR)
+#define PRR       _HOST_SFR8(HR_PRR)
+#define TCNT1     _HOST_SFR8(HR_TCNT1)
+#define TCCR1     _HOST_SFR8(HR_TCCR1)
+#define GTCCR     _HOST_SFR8(HR_GTCCR)
+#define OCR1A     _HOST_SFR8(HR_OCR1A)
+#define OCR1B     _HOST_SFR8(HR_OCR1B)
+#define OCR1C     _HOST_SFR8(HR_OCR1C)
+#define PLLCSR    _HOST_SFR8(HR_PLLCSR)
+#define GIMSK     _HOST_SFR8(HR_GIMSK)
+#define PCMSK     _HOST_SFR8(HR_PCMSK)
+#define GIFR      _HOST_SFR8(HR_GIFR)
+#define SREG      _HOST_SFR8(HR_SREG)
+#define OSCCAL    _HOST_SFR8(HR_OSCCAL)
+
+
+/* Memory */
+#define RAMSTART  0x60
+#define RAMEND    0x25f
+#define E2END     0x1ff
+
+
+/* Bits */
+#define PB0       0
+#define PB1       1
+#define PB2       2
+#define PB3       3
+#define PB4       4
+#define PB5       5
+#define PINB0     0
+#define PINB1     1
+#define PINB2     2
+#define PINB3     3
+#define PINB4     4
+#define PINB5     5
+
+#define USISIF    7
+#define USIOIF    6
+#define USIPF     5
+#define USIDC     4
+#define USICNT0   0
+#define USISIE    7
+#define USIOIE    6
+#define USIWM1    5
+#define USIWM0    4
+#define USICS1    3
+#define USICS0    2
+#define USICLK    1
+#define USITC     0
+
+#define EEPM1     5
+#define EEPM0     4
+#define EERIE     3
+#define EEMPE     2
+#define EEPE      1
+#define EERE      0
+
+#define WGM01     1
+#define WGM00     0
+#define WGM02     3
+#define CS02      2
+#define CS01      1
+#define CS00      0
+#define OCIE1A    6
+#define OCIE1B    5
+#define OCIE0A    4
+#define OCIE0B    3
+#define TOIE1     2
+#define TOIE0     1
+#define OCF1A     6
+#define OCF1B     5
+#define OCF0A     4
+#define OCF0B     3
+#define TOV1      2
+#define TOV0      1
+
+#define CTC1      7
+#define PWM1A     6
+#define CS13      3
+#define CS12      2
+#define CS11      1
+#define CS10      0
+#define TSM       7
+#define PSR1      1
+#define PSR0      0
+#define PLLE      1
+#define PLOCK     0
+#define PCKE      2
+#define LSM       7
+
+#define WDIF      7
+#define WDIE      6
+#define WDP3      5
+#define WDCE      4
+#define WDE       3
+#define WDP2      2
+#define WDP1      1
+#define WDP0      0
+
+#define WDRF      3
+#define BORF      2
+#define EXTRF     1
+#define PORF      0
+
+#define BODS      7
+#define PUD       6
+#define SE        5
+#define SM1       4
+#define SM0       3
+
+#define ACD       7
+#define PRTIM1    3
+#define PRTIM0    2
+#define PRUSI     1
+#define PRADC     0
+
+#define INT0      6
+#define PCIE      5
+#define INTF0     6
+#define PCIF      5
+#define PCINT0    0
+#define PCINT1    1
+#define PCINT2    2
+#define PCINT3    3
+#define PCINT4    4
+#define PCINT5    5
+
+#define SREG_I    7
+
+
+#endif /* HOST_IO_H_ */
@@ -0,0 +1,10 @@
+/*
+ * Filename: iotn85.h
+ * Description: Host build stand-in, the registers come from io.h.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#include <avr/io.h>
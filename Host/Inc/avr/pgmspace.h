@@ -0,0 +1,33 @@
+/*
+ * Filename: pgmspace.h
+ * Description: Host build program space access, flash is ordinary memory.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_PGMSPACE_H_
+#define HOST_PGMSPACE_H_
+
+
+#include <stdint.h>
+#include <string.h>
+
+
+#define PROGMEM
+#define PSTR(s)             (s)
+
+#define pgm_read_byte(a)    (*(const uint8_t*)(a))
+#define pgm_read_word(a)    (*(const uint16_t*)(a))
+#define pgm_read_dword(a)   (*(const uint32_t*)(a))
+#define pgm_read_ptr(a)     (*(void* const*)(a))
+
+#define printf_P            printf
+#define sprintf_P           sprintf
+#define memcpy_P            memcpy
+#define strlen_P            strlen
+#define strcpy_P            strcpy
+
+
+#endif /* HOST_PGMSPACE_H_ */
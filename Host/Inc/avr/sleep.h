@@ -0,0 +1,29 @@
+/*
+ * Filename: sleep.h
+ * Description: Host build sleep, the simulated clock runs to the next
+ *              interrupt.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_SLEEP_H_
+#define HOST_SLEEP_H_
+
+
+#include <avr/io.h>
+
+
+#define SLEEP_MODE_IDLE       0
+#define SLEEP_MODE_ADC        _BV(SM0)
+#define SLEEP_MODE_PWR_DOWN   _BV(SM1)
+
+#define set_sleep_mode(mode)  do { MCUCR = (MCUCR & ~(_BV(SM1)|_BV(SM0))) | (mode); } while (0)
+#define sleep_enable()        do { MCUCR |= _BV(SE); } while (0)
+#define sleep_disable()       do { MCUCR &= ~_BV(SE); } while (0)
+#define sleep_cpu()           Host_Sleep()
+#define sleep_mode()          do { sleep_enable(); sleep_cpu(); sleep_disable(); } while (0)
+
+
+#endif /* HOST_SLEEP_H_ */
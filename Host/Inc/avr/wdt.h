@@ -0,0 +1,36 @@
+/*
+ * Filename: wdt.h
+ * Description: Host build watchdog control.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_WDT_H_
+#define HOST_WDT_H_
+
+
+#include <avr/io.h>
+
+
+#define WDTO_15MS   0
+#define WDTO_30MS   1
+#define WDTO_60MS   2
+#define WDTO_120MS  3
+#define WDTO_250MS  4
+#define WDTO_500MS  5
+#define WDTO_1S     6
+#define WDTO_2S     7
+#define WDTO_4S     8
+#define WDTO_8S     9
+
+#define wdt_reset()       Host_WdtReset()
+#define wdt_disable()     do { WDTCR = _BV(WDCE)|_BV(WDE); WDTCR = 0; } while (0)
+#define wdt_enable(t)     do { \
+  WDTCR = _BV(WDCE)|_BV(WDE); \
+  WDTCR = _BV(WDE)|((t) & 0x07)|(((t) & 0x08) ? _BV(WDP3) : 0); \
+} while (0)
+
+
+#endif /* HOST_WDT_H_ */
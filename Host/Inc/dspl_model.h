@@ -0,0 +1,79 @@
+/*
+ * Filename: dspl_model.h
+ * Description: A set of definitions for the virtual displays on the I2C bus:
+ *              the WH1602 behind a PCF8574 backpack and the SSD1315 OLED.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 01:32:48 PM
+ * Author: Dmitry Slobodchikov
+ */
+#ifndef DSPL_MODEL_H_
+#define DSPL_MODEL_H_
+
+
+#include <avr/io.h>
+#include "i2c_model.h"
+
+
+#define DSPM_WH1602_ADDR    0x27
+#define DSPM_SSD1315_ADDR   0x3c
+
+#define DSPM_LCD_COLS       16
+#define DSPM_LCD_ROWS       2
+#define DSPM_OLED_COLS      128
+#define DSPM_OLED_PAGES     8
+
+/* --- Environment, attaches the models and names the capture files --- */
+/* --- <prefix>.txt per printf records and text frames, --- */
+/* --- <prefix>_NNNNN.pbm OLED frames --- */
+#define DSPM_ENV_CAPTURE    "SML_DSPL_CAPTURE"
+
+/* --- Environment, the panels plugged in: "lcd", "oled", "lcd,oled" (the --- */
+/* --- default) or "none" --- */
+#define DSPM_ENV_PANELS     "SML_DSPL_PANELS"
+
+
+/* HD44780 controller behind the PCF8574 port expander */
+typedef struct {
+  uint8_t   port;           // PCF8574 output latch
+  uint8_t   bus8;           // 8-bit interface, the power-on state
+  uint8_t   nibble;         // high nibble of a 4-bit transfer
+  uint8_t   half;           // the high nibble is taken
+  uint8_t   addr;           // address counter
+  uint8_t   cgram;          // the counter points into CGRAM
+  uint8_t   on;             // display on
+  uint8_t   lines2;
+  uint8_t   ddram[0x68];
+  uint64_t  busyEnd;
+  uint32_t  busyHits;       // writes before the previous instruction is done
+} dspm_lcd_t;
+
+
+/* SSD1315 controller */
+typedef struct {
+  uint8_t   cmd;            // command waiting for arguments
+  uint8_t   argNeed;
+  uint8_t   argCnt;
+  uint8_t   args[6];
+  uint8_t   ctl;            // 1 = control byte next, 2 = after one byte
+  uint8_t   data;           // D/C of the stream
+  uint8_t   mode;           // 0 horizontal, 1 vertical, 2 page addressing
+  uint8_t   colStart, colEnd, col;
+  uint8_t   pageStart, pageEnd, page;
+  uint8_t   remap, comRev, invert, allOn, on, startLine;
+  uint8_t   gddram[DSPM_OLED_PAGES][DSPM_OLED_COLS];
+  uint32_t  cmdBytes;
+  uint32_t  dataBytes;
+} dspm_oled_t;
+
+
+/* Exported functions */
+void DSPM_Init(const char*);
+dspm_lcd_t* DSPM_Lcd(void);
+dspm_oled_t* DSPM_Oled(void);
+void DSPM_LcdText(char*);
+void DSPM_OledPbm(FILE*);
+
+
+#endif /* DSPL_MODEL_H_ */
@@ -0,0 +1,115 @@
+/*
+ * Filename: host.h
+ * Description: A set of definitions for the host-native build HAL.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_H_
+#define HOST_H_
+
+
+#include <stdint.h>
+#include <stdio.h>
+
+
+#define HOST_BUILD
+
+#ifndef F_CPU
+#define F_CPU 16000000
+#endif
+
+
+/* --- Emulated I/O registers, indexes in the register page --- */
+#define HR_PORTB        0
+#define HR_DDRB         1
+#define HR_PINB         2
+#define HR_USIDR        3
+#define HR_USISR        4
+#define HR_USICR        5
+#define HR_USIBR        6
+#define HR_EECR         7
+#define HR_EEDR         8
+#define HR_EEARL        10 // EEAR is accessed as a 16-bit pair, kept aligned
+#define HR_EEARH        11
+#define HR_TCNT0        12
+#define HR_TCCR0A       13
+#define HR_TCCR0B       14
+#define HR_OCR0A        15
+#define HR_OCR0B        16
+#define HR_TIMSK        17
+#define HR_TIFR         18
+#define HR_WDTCR        19
+#define HR_MCUSR        20
+#define HR_MCUCR        21
+#define HR_ACSR         22
+#define HR_PRR          23
+#define HR_TCNT1        24
+#define HR_TCCR1        25
+#define HR_GTCCR        26
+#define HR_OCR1A        27
+#define HR_OCR1B        28
+#define HR_OCR1C        29
+#define HR_PLLCSR       30
+#define HR_GIMSK        31
+#define HR_PCMSK        32
+#define HR_GIFR         33
+#define HR_SREG         34
+#define HR_OSCCAL       35
+#define HR_COUNT        36
+
+/* --- _NOP cost, eight of them make the nominal 1 us step of _delay_us --- */
+#define HOST_NOP_CYCLES (F_CPU / 8000000UL)
+
+/* --- Run control environment variables --- */
+#define HOST_ENV_MS     "SML_HOST_MS"     // simulated run length, ms, 0 = endless
+#define HOST_ENV_EEPROM "SML_HOST_EEPROM" // EEPROM image file, loaded and saved back
+#define HOST_RUN_MS     10000
+
+/* --- Exit codes --- */
+#define HOST_EXIT_DONE  0
+#define HOST_EXIT_WDR   3 // watchdog reset
+#define HOST_EXIT_FAIL  4 // a model report failed
+
+
+/* An external device on PORTB, gives the lines it pulls low */
+/* --- drive: lines the MCU pulls low, strong: lines the MCU drives high --- */
+/* --- pins: resolved levels before the call --- */
+typedef uint8_t (*host_bus_t)(uint8_t drive, uint8_t strong, uint8_t pins);
+
+/* A stream observer, called with done = 0 before the firmware putc sees */
+/* --- the chunk and with done = 1 after, one chunk per printf --- */
+typedef void (*host_stream_t)(const char* buf, size_t len, uint8_t done);
+
+/* A clock sampler, called with the number of sample periods passed */
+typedef void (*host_sample_t)(uint32_t n);
+
+/* A model run report, printed when the run ends, non-zero fails the run */
+typedef uint8_t (*host_report_t)(FILE* out);
+
+/* --- Constructor order, device models attach after the HAL is up --- */
+#define HOST_INIT_HAL   101
+#define HOST_INIT_MODEL 102
+
+
+/* Exported functions */
+volatile uint8_t* Host_Reg(uint8_t);
+uint8_t Host_Advance(uint32_t);
+void Host_Spin(uint32_t);
+void Host_Sleep(void);
+void Host_Cli(void);
+void Host_Sei(void);
+void Host_WdtReset(void);
+uint64_t Host_Cycles(void);
+void Host_SetRunLimit(uint32_t);
+uint8_t Host_AddBus(host_bus_t);
+void Host_Override(host_bus_t, uint8_t);
+uint8_t Host_AddStream(host_stream_t);
+uint8_t Host_AddReport(host_report_t);
+void Host_SetSampler(host_sample_t, uint32_t);
+FILE* Host_FdevOpen(int (*)(char, FILE*));
+
+
+#endif /* HOST_H_ */
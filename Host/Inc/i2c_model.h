@@ -0,0 +1,56 @@
+/*
+ * Filename: i2c_model.h
+ * Description: A set of definitions for the simulated I2C bus slaves on the
+ *              USI two-wire lines.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 10:05:12 AM
+ * Author: Dmitry Slobodchikov
+ */
+#ifndef I2C_MODEL_H_
+#define I2C_MODEL_H_
+
+
+#include <avr/io.h>
+
+
+#define I2CM_SDA        0   // PB0
+#define I2CM_SCL        2   // PB2
+#define I2CM_MAX_DEV    4
+
+
+/* A write-only slave, the engine does the addressing and the ACK clock */
+typedef struct {
+  uint8_t   addr;               // 7-bit address
+  void      (*start)(void);     // addressed for write
+  uint8_t   (*write)(uint8_t);  // data byte, returns 1 to ACK
+  void      (*stop)(void);      // STOP or repeated START
+  uint32_t  maxHz;              // rated SCL clock, 0 = not checked
+} i2cm_dev_t;
+
+
+/* Bus activity counters */
+typedef struct {
+  uint32_t  starts;     // STARTs and repeated STARTs
+  uint32_t  stops;
+  uint32_t  bytes;      // every byte clocked, addresses included
+  uint32_t  nacks;
+  uint64_t  busCycles;  // START to STOP
+  /* --- SCL timing of each slave's own transactions, in model order --- */
+  uint32_t  minLow[I2CM_MAX_DEV];   // cycles, 0 = not seen
+  uint32_t  minHigh[I2CM_MAX_DEV];
+  uint32_t  fast[I2CM_MAX_DEV];     // clocks shorter than the slave's rating
+} i2cm_stat_t;
+
+
+/* Exported functions */
+uint8_t I2CM_AddDevice(const i2cm_dev_t*);
+i2cm_stat_t* I2CM_Stat(void);
+void I2CM_ResetStat(void);
+void I2CM_HoldScl(uint32_t);
+void I2CM_StickSda(uint8_t);
+void I2CM_SetPresent(uint8_t, uint8_t);
+
+
+#endif /* I2C_MODEL_H_ */
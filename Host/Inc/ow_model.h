@@ -0,0 +1,79 @@
+/*
+ * Filename: ow_model.h
+ * Description: A set of definitions for the simulated 1-Wire bus with
+ *              virtual DS18B20 sensors.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 02:14:37 PM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef OW_MODEL_H_
+#define OW_MODEL_H_
+
+
+#include <avr/io.h>
+
+
+#define OWM_PIN         4   // PB4
+#define OWM_MAX_DEV     32
+#define OWM_FAMILY      0x28 // DS18B20
+#define OWM_TEMP_POR    0x0550 // 85 C power-on reset value, 1/16 C
+
+/* --- Environment, attaches the model to the firmware run --- */
+/* --- "N" external power, "N:p" parasite power --- */
+#define OWM_ENV_DEVICES "SML_OW_DEVICES"
+
+
+/* Bus timing as the devices see it, microseconds */
+typedef struct {
+  uint16_t  resetUs;          // shortest low pulse taken as a reset
+  uint16_t  sampleUs;         // write slot sample point after the falling edge
+  uint16_t  holdUs;           // read slot 0 hold time after the falling edge
+  uint16_t  presenceDelayUs;  // reset release to presence
+  uint16_t  presenceUs;       // presence pulse length
+  uint16_t  convMs;           // temperature conversion time
+  uint16_t  copyMs;           // scratchpad to EEPROM copy time
+} owm_cfg_t;
+
+
+/* A virtual DS18B20 */
+typedef struct {
+  uint8_t   rom[8];
+  int16_t   temp;       // actual temperature, 1/16 C
+  uint8_t   parasite;
+  uint8_t   pad[9];     // scratchpad, the last byte is CRC
+  uint8_t   ee[3];      // TH, TL, configuration
+  uint8_t   active;     // selected by the ROM command
+  uint8_t   converting;
+  uint8_t   powerLost;  // parasite conversion without the strong pull-up
+  uint64_t  convEnd;
+} owm_dev_t;
+
+
+/* Bus activity counters */
+typedef struct {
+  uint32_t  resets;
+  uint32_t  presences;
+  uint32_t  readSlots;
+  uint32_t  writeSlots;
+  uint32_t  searches;
+  uint32_t  conversions;
+  uint32_t  crcInjected;
+} owm_stat_t;
+
+
+/* Exported functions */
+void OWM_Init(const owm_cfg_t*);
+void OWM_Clear(void);
+uint8_t OWM_AddDevice(const uint8_t*, int16_t, uint8_t);
+void OWM_MakeRom(uint8_t*, uint32_t);
+void OWM_InjectCrcErrors(uint8_t);
+owm_dev_t* OWM_Device(uint8_t);
+uint8_t OWM_DeviceCount(void);
+owm_cfg_t* OWM_Config(void);
+owm_stat_t* OWM_Stat(void);
+void OWM_ResetStat(void);
+
+
+#endif /* OW_MODEL_H_ */
@@ -0,0 +1,25 @@
+/*
+ * Filename: stdio.h
+ * Description: Host build stdio, avr-libc stream setup over the C library.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_STDIO_H_
+#define HOST_STDIO_H_
+
+
+#include_next <stdio.h>
+
+
+#define _FDEV_SETUP_READ    1
+#define _FDEV_SETUP_WRITE   2
+#define _FDEV_SETUP_RW      3
+
+/* --- Streams are opened at run time, see Host_FdevOpen() --- */
+#define fdev_setup_stream(s, p, g, f) ((void)0)
+
+
+#endif /* HOST_STDIO_H_ */
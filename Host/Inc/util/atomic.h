@@ -0,0 +1,39 @@
+/*
+ * Filename: atomic.h
+ * Description: Host build atomic blocks, same scheme as avr-libc on the
+ *              emulated SREG.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef HOST_ATOMIC_H_
+#define HOST_ATOMIC_H_
+
+
+#include <avr/interrupt.h>
+
+
+static inline uint8_t __iCliRetVal(void) {
+  cli();
+  return 1;
+}
+
+static inline void __iSeiParam(const uint8_t* __s) {
+  (void)__s;
+  sei();
+}
+
+static inline void __iRestore(const uint8_t* __s) {
+  SREG = *__s;
+  if (*__s & _BV(SREG_I)) sei();
+}
+
+
+#define ATOMIC_BLOCK(type)  for (type, __ToDo = __iCliRetVal(); __ToDo; __ToDo = 0)
+#define ATOMIC_RESTORESTATE uint8_t sreg_save __attribute__((__cleanup__(__iRestore))) = SREG
+#define ATOMIC_FORCEON      uint8_t sreg_save __attribute__((__cleanup__(__iSeiParam))) = 0
+
+
+#endif /* HOST_ATOMIC_H_ */
@@ -0,0 +1,341 @@
+/*
+ * Filename: bench.c
+ * Description: The driver hot path benchmark for the host-native build.
+ *              Counts the emulated I/O cycles, the bus time and the host
+ *              time of each operation and writes the results as JSON lines
+ *              for revision comparison.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 11:40:05 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+/* --- Unity build, the display chain state and Cron() are reached directly --- */
+#define main Firmware_Main
+#include "../../main.c"
+#undef main
+#include "../../Periph/Src/display.c"
+#include "ow_model.h"
+#include "dspl_model.h"
+
+#include <string.h>
+#include <time.h>
+
+
+#define BENCH_ENV_OUT   "SML_BENCH_OUT"   // result file, JSON lines
+#define BENCH_ENV_REV   "SML_BENCH_REV"   // firmware revision tag
+#define BENCH_OUT       "bench.json"
+#define BENCH_REPS      32
+#define BENCH_OW_SEED   0x2545f491UL
+#define BENCH_LINE      "T:21.50\n"      // a printed line, the clear before it included
+
+
+/* A benchmark case, div splits one run into per-unit figures */
+typedef struct {
+  const char* name;
+  uint16_t    reps;
+  uint16_t    div;
+  void        (*setup)(void);
+  void        (*run)(void);
+} bench_t;
+
+
+/* Private variables */
+static uint8_t benchAddr[8];
+static uint8_t benchBuf[16];
+
+/* Private function definitions */
+static void Bench_Init(void);
+static void Bench_Exec(const bench_t*, FILE*, const char*);
+static void Bench_OneWireScaling(FILE*, const char*);
+static void Bench_I2CSetup(void);
+static void Bench_I2CSetupFm(void);
+static void Bench_I2CSetupFmp(void);
+static void Bench_I2COpen(uint8_t, uint8_t);
+static void Bench_I2CSendByte(void);
+static void Bench_DsplIdle(void);
+static void Bench_DsplLine(void);
+static void Bench_DsplDrain(void);
+static void Bench_OneWireReadByte(void);
+static void Bench_OneWireWriteByte(void);
+static void Bench_DS18B20ReadScratchpad(void);
+static void Bench_EepromWrite(void);
+static void Bench_CronSetup(void);
+static void Bench_Cron(void);
+
+
+static const bench_t benches[] = {
+  {"I2C_SendByte",            BENCH_REPS, 1,  Bench_I2CSetup,  Bench_I2CSendByte},
+  {"I2C_SendByte/400k",       BENCH_REPS, 1,  Bench_I2CSetupFm,  Bench_I2CSendByte},
+  {"I2C_SendByte/1M",         BENCH_REPS, 1,  Bench_I2CSetupFmp, Bench_I2CSendByte},
+  {"putc_dspl/line",          BENCH_REPS, 1,  Bench_DsplIdle,  Bench_DsplLine},
+  {"Dspl_Drain/line",         BENCH_REPS, 1,  Bench_DsplLine,  Bench_DsplDrain},
+  {"OneWire_ReadByte",        BENCH_REPS, 1,  NULL,            Bench_OneWireReadByte},
+  {"OneWire_WriteByte",       BENCH_REPS, 1,  NULL,            Bench_OneWireWriteByte},
+  {"DS18B20_ReadScrachpad",   BENCH_REPS, 1,  NULL,            Bench_DS18B20ReadScratchpad},
+  {"EEPROM_WriteBuffer/byte", 4,          16, NULL,            Bench_EepromWrite},
+  {"Cron",                    BENCH_REPS, 1,  Bench_CronSetup, Bench_Cron},
+};
+
+
+
+/**
+ * @brief   Runs every benchmark case and writes the result file.
+ * @retval  (int) process exit code
+ */
+int main(void) {
+  const char* path = getenv(BENCH_ENV_OUT);
+  const char* rev = getenv(BENCH_ENV_REV);
+  FILE* out = fopen(path ? path : BENCH_OUT, "w");
+  if (!out) {
+    perror("bench");
+    return 1;
+  }
+
+  Bench_Init();
+  printf("%-26s %6s %10s %10s %10s %10s %10s\n", "case", "reps", "io.min", "io.avg", "io.max", "bus.us",
+         "host.ns");
+  for (uint8_t i = 0; i < sizeof(benches) / sizeof(benches[0]); i++) {
+    Bench_Exec(&benches[i], out, rev ? rev : "");
+  }
+  Bench_OneWireScaling(out, rev ? rev : "");
+  fclose(out);
+  return 0;
+}
+
+
+/**
+ * @brief   Brings the firmware up as main() does, with interrupts kept off
+ *          so no ISR lands inside a measurement.
+ * @retval  none
+ */
+static void Bench_Init(void) {
+  Host_SetRunLimit(0);
+  cli();
+  _INIT_MCU;
+  _INIT_LED;
+  _INIT_TIMERS;
+  _INIT_I2C;
+  Init_ISR();
+  Init_Scheduler();
+  _i2creg = Get_I2CREG();
+
+  /* --- The display models answer the I2C cases, a NACK would end a burst --- */
+  DSPM_Init(NULL);
+  Init_Display();
+
+  /* --- One externally powered sensor for the 1-Wire cases --- */
+  OWM_Init(NULL);
+  OWM_MakeRom(benchAddr, 1);
+  OWM_AddDevice(benchAddr, 21 * 16, 0);
+  if (!Init_OneWire()) FLAG_SET(_PREG_, _OWBUSRF_);
+  if (!Init_DigitalDisplay()) FLAG_SET(_PREG_, _DIGDRF_);
+}
+
+
+/**
+ * @brief   Runs one case and reports it.
+ * @param   b the case
+ * @param   out result file
+ * @param   rev firmware revision tag
+ * @retval  none
+ */
+static void Bench_Exec(const bench_t* b, FILE* out, const char* rev) {
+  uint64_t min = UINT64_MAX, max = 0, sum = 0;
+  uint64_t ns = 0;
+  struct timespec t0, t1;
+
+  for (uint16_t i = 0; i < b->reps; i++) {
+    if (b->setup) b->setup();
+    uint64_t c0 = Host_Cycles();
+    clock_gettime(CLOCK_MONOTONIC, &t0);
+    b->run();
+    clock_gettime(CLOCK_MONOTONIC, &t1);
+    uint64_t c = (Host_Cycles() - c0) / b->div;
+
+    ns += (uint64_t)(t1.tv_sec - t0.tv_sec) * 1000000000ULL + (t1.tv_nsec - t0.tv_nsec);
+    sum += c;
+    if (c < min) min = c;
+    if (c > max) max = c;
+  }
+
+  uint64_t avg = sum / b->reps;
+  double us = (double)avg * 1e6 / F_CPU;
+  double hostNs = (double)ns / b->reps / b->div;
+
+  printf("%-26s %6u %10llu %10llu %10llu %10.1f %10.0f\n", b->name, b->reps,
+         (unsigned long long)min, (unsigned long long)avg, (unsigned long long)max, us, hostNs);
+  fprintf(out, "{\"rev\":\"%s\",\"case\":\"%s\",\"reps\":%u,\"io_cyc_min\":%llu,\"io_cyc_avg\":%llu,"
+               "\"io_cyc_max\":%llu,\"bus_us\":%.1f,\"host_ns\":%.0f}\n",
+          rev, b->name, b->reps, (unsigned long long)min, (unsigned long long)avg,
+          (unsigned long long)max, us, hostNs);
+}
+
+
+/**
+ * @brief   Measures the ROM search as the bus grows to the 15-device limit
+ *          and beyond. Each size is enumerated twice, the second pass finds
+ *          the addresses in EEPROM already and gives the bus-only figure.
+ * @param   out result file
+ * @param   rev firmware revision tag
+ * @retval  none
+ */
+static void Bench_OneWireScaling(FILE* out, const char* rev) {
+  static const uint8_t sizes[] = {1, 2, 4, 8, 12, 15, 16, 20, 24};
+  uint32_t seed = BENCH_OW_SEED;
+
+  printf("\n%-26s %6s %6s %6s %10s %8s %8s\n", "case", "devs", "found", "stored", "bus.ms", "slots", "resets");
+  for (uint8_t s = 0; s < sizeof(sizes); s++) {
+    uint8_t n = sizes[s];
+    uint8_t rom[8];
+
+    OWM_Clear();
+    for (uint8_t i = 0; i < n; i++) {
+      seed = seed * 1664525UL + 1013904223UL;
+      OWM_MakeRom(rom, seed);
+      OWM_AddDevice(rom, 20 * 16, 0);
+    }
+    Init_OneWire();
+
+    OWM_ResetStat();
+    uint64_t c0 = Host_Cycles();
+    Init_OneWire();
+    double ms = (double)(Host_Cycles() - c0) * 1e3 / F_CPU;
+
+    /* --- Devices whose ROM ended up in the EEPROM address table --- */
+    uint8_t stored = 0;
+    for (uint8_t i = 0; i < n; i++) {
+      for (uint8_t j = 0; j < n; j++) {
+        EEPROM_ReadBuffer(EE_OW_ADDR + j * 8, rom, sizeof(rom));
+        if (!memcmp(rom, OWM_Device(i)->rom, sizeof(rom))) {
+          stored++;
+          break;
+        }
+      }
+    }
+
+    owm_stat_t* st = OWM_Stat();
+    uint32_t slots = st->readSlots + st->writeSlots;
+    uint8_t found = *Get_OWREG() & 0x0f;
+    printf("%-26s %6u %6u %6u %10.1f %8u %8u\n", "OneWire_Enumerate", n, found, stored, ms, slots, st->resets);
+    fprintf(out, "{\"rev\":\"%s\",\"case\":\"OneWire_Enumerate\",\"devices\":%u,\"found\":%u,"
+                 "\"stored\":%u,\"bus_ms\":%.1f,\"slots\":%u,\"resets\":%u,\"searches\":%u}\n",
+            rev, n, found, stored, ms, slots, st->resets, st->searches);
+  }
+}
+
+
+/**
+ * @brief   Opens a write transaction to the character display at its speed.
+ * @retval  none
+ */
+static void Bench_I2CSetup(void) {
+  Bench_I2COpen(_1602A_ADDR_, _1602A_SPEED_);
+}
+
+
+static void Bench_I2CSetupFm(void) {
+  Bench_I2COpen(_SSD1315_ADDR_, I2C_SPEED_FM);
+}
+
+
+static void Bench_I2CSetupFmp(void) {
+  Bench_I2COpen(_SSD1315_ADDR_, I2C_SPEED_FMP);
+}
+
+
+/**
+ * @brief   Opens a write transaction.
+ * @param   addr slave address
+ * @param   speed I2C_SPEED_*
+ * @retval  none
+ */
+static void Bench_I2COpen(uint8_t addr, uint8_t speed) {
+  I2C_Stop();
+  I2C_SetSpeed(speed);
+  I2C_WRITE;
+  I2C_Start();
+  I2C_SendAddress(addr);
+}
+
+
+static void Bench_I2CSendByte(void) {
+  I2C_SendByte(0x5a);
+}
+
+
+/**
+ * @brief   Ends a transaction the I2C cases left open and lets the display
+ *          chain run dry, so a line starts on an idle bus and queue.
+ * @retval  none
+ */
+static void Bench_DsplIdle(void) {
+  I2C_Stop();
+  if (dsplRun) Bench_DsplDrain();
+}
+
+
+/**
+ * @brief   Prints a line to the displays. The caller only fills the text
+ *          ring and queues the first transaction, the bus work follows in
+ *          the interrupt.
+ * @retval  none
+ */
+static void Bench_DsplLine(void) {
+  for (const char* c = BENCH_LINE; *c; c++) putc_dspl(*c, NULL);
+}
+
+
+/**
+ * @brief   Runs the queue steps with interrupts on until the text ring is
+ *          drained to every panel. The ticks of the run are thrown away.
+ * @retval  none
+ */
+static void Bench_DsplDrain(void) {
+  event_t ev;
+
+  sei();
+  while (dsplRun) Host_Spin(F_CPU / 1000000UL);
+  cli();
+  while (Event_Pop(&ev));
+}
+
+
+static void Bench_OneWireReadByte(void) {
+  benchBuf[0] = OneWire_ReadByte();
+}
+
+
+static void Bench_OneWireWriteByte(void) {
+  OneWire_WriteByte(0xcc);
+}
+
+
+static void Bench_DS18B20ReadScratchpad(void) {
+  DS18B20_ReadScrachpad(benchAddr, benchBuf);
+}
+
+
+/**
+ * @brief   Writes 16 bytes to a scratch EEPROM area, the figure is per byte.
+ * @retval  none
+ */
+static void Bench_EepromWrite(void) {
+  memset(benchBuf, 0x5a, sizeof(benchBuf));
+  EEPROM_WriteBuffer(E2END + 1 - sizeof(benchBuf), benchBuf, sizeof(benchBuf));
+}
+
+
+/**
+ * @brief   Queues one tick event, as the Timer0 ISR would.
+ * @retval  none
+ */
+static void Bench_CronSetup(void) {
+  Event_PushISR(Get_EventRing(), EV_TICK, 1);
+}
+
+
+static void Bench_Cron(void) {
+  Cron();
+}
@@ -0,0 +1,532 @@
+/*
+ * Filename: dspl_model.c
+ * Description: The virtual displays on the simulated I2C bus. The WH1602
+ *              decodes the PCF8574 port writes into E-strobed HD44780
+ *              nibbles, the SSD1315 decodes control bytes, commands and
+ *              GDDRAM writes. Every firmware printf is followed by a record
+ *              of its I2C cost and, when the picture changed, a frame.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 01:32:48 PM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "dspl_model.h"
+
+
+#define US(us)          ((uint64_t)(us) * (F_CPU / 1000000UL))
+
+/* --- PCF8574 port lines of the backpack --- */
+#define PCF_RS          0
+#define PCF_RW          1
+#define PCF_E           2
+#define PCF_BL          3
+
+/* --- HD44780 execution times, us --- */
+#define HD_EXEC_US      37
+#define HD_HOME_US      1520
+
+/* --- SSD1315 control byte --- */
+#define OLED_CO         7
+#define OLED_DC         6
+
+/* --- Bus model slots, in the order of attach --- */
+#define DSPM_LCD_DEV    0
+#define DSPM_OLED_DEV   1
+
+#define DSPM_PATH_MAX   256
+#define DSPM_TEXT_MAX   64
+
+
+/* Private variables */
+static dspm_lcd_t   lcd;
+static dspm_oled_t  oled;
+static uint8_t      lcdDirty  = 0;
+static uint8_t      oledDirty = 0;
+
+static FILE*        capTxt    = NULL;
+static const char*  capPrefix = NULL;
+static uint32_t     frames    = 0;
+static uint32_t     pbms      = 0;
+static i2cm_stat_t  prnStat;            // bus counters when the printf began
+static uint64_t     prnAt     = 0;
+static uint32_t     prnCnt    = 0;
+static uint64_t     prnBusMax = 0;
+static char         prnText[DSPM_TEXT_MAX]; // the printf waiting for its record
+static size_t       prnLen    = 0;
+static uint64_t     prnCall   = 0;
+static uint8_t      prnOpen   = 0;
+
+/* Private function definitions */
+static void DSPM_Attach(void) __attribute__((constructor(HOST_INIT_MODEL)));
+static uint8_t Lcd_Write(uint8_t);
+static void Lcd_Latch(uint8_t);
+static void Lcd_Exec(uint8_t, uint8_t);
+static void Oled_Start(void);
+static uint8_t Oled_Write(uint8_t);
+static void Oled_Command(uint8_t);
+static void Oled_Data(uint8_t);
+static void DSPM_Stream(const char*, size_t, uint8_t);
+static void DSPM_Record(void);
+static uint8_t DSPM_Report(FILE*);
+static double DSPM_Ns(uint32_t);
+
+/* --- Rated SCL clocks: the PCF8574 backpack, and the SSD1315 as the firmware runs it --- */
+static const i2cm_dev_t lcdDev  = {DSPM_WH1602_ADDR, NULL, Lcd_Write, NULL, 100000};
+static const i2cm_dev_t oledDev = {DSPM_SSD1315_ADDR, Oled_Start, Oled_Write, NULL, 1000000};
+
+
+
+/**
+ * @brief   Attaches the models to the firmware run, the firmware finds its
+ *          panels by a bus scan.
+ * @retval  none
+ */
+static void DSPM_Attach(void) {
+  const char* env = getenv(DSPM_ENV_CAPTURE);
+  DSPM_Init((env && *env) ? env : NULL);
+}
+
+
+/**
+ * @brief   Puts both controllers into the power-on state and hooks them on
+ *          the bus, the ones SML_DSPL_PANELS leaves out do not answer.
+ * @param   prefix capture file prefix, NULL for no capture
+ * @retval  none
+ */
+void DSPM_Init(const char* prefix) {
+  memset(&lcd, 0, sizeof(lcd));
+  memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+  lcd.port = 0xff;
+  lcd.bus8 = 1;
+
+  memset(&oled, 0, sizeof(oled));
+  oled.colEnd = DSPM_OLED_COLS - 1;
+  oled.pageEnd = DSPM_OLED_PAGES - 1;
+  oled.mode = 2;
+
+  if (prefix && !capTxt) {
+    char path[DSPM_PATH_MAX];
+    snprintf(path, sizeof(path), "%s.txt", prefix);
+    capTxt = fopen(path, "w");
+    if (!capTxt) perror(path);
+    capPrefix = prefix;
+  }
+
+  static uint8_t attached = 0;
+  if (!attached) {
+    I2CM_AddDevice(&lcdDev);
+    I2CM_AddDevice(&oledDev);
+    Host_AddStream(DSPM_Stream);
+    Host_AddReport(DSPM_Report);
+    attached = 1;
+  }
+
+  const char* panels = getenv(DSPM_ENV_PANELS);
+  if (!panels) panels = "lcd,oled";
+  I2CM_SetPresent(DSPM_WH1602_ADDR, strstr(panels, "lcd") ? 1 : 0);
+  I2CM_SetPresent(DSPM_SSD1315_ADDR, strstr(panels, "oled") ? 1 : 0);
+}
+
+
+/* --- WH1602 block --- */
+
+/**
+ * @brief   PCF8574 port write, the falling edge of E latches a transfer.
+ * @param   byte new port state
+ * @retval  (uint8_t) 1 = ACK
+ */
+static uint8_t Lcd_Write(uint8_t byte) {
+  uint8_t prev = lcd.port;
+
+  lcd.port = byte;
+  if ((prev & _BV(PCF_E)) && !(byte & _BV(PCF_E)) && !(byte & _BV(PCF_RW))) {
+    Lcd_Latch(byte);
+  }
+  return 1;
+}
+
+
+/**
+ * @brief   HD44780 bus transfer on D7..D4, whole byte in the 8-bit mode,
+ *          high then low nibble in the 4-bit one.
+ * @param   port PCF8574 port state
+ * @retval  none
+ */
+static void Lcd_Latch(uint8_t port) {
+  uint8_t rs = port & _BV(PCF_RS);
+
+  if (!lcd.half && (Host_Cycles() < lcd.busyEnd)) lcd.busyHits++;
+
+  if (lcd.bus8) {
+    Lcd_Exec(rs, port & 0xf0);
+  } else if (!lcd.half) {
+    lcd.nibble = port & 0xf0;
+    lcd.half = 1;
+  } else {
+    lcd.half = 0;
+    Lcd_Exec(rs, lcd.nibble | (port >> 4));
+  }
+}
+
+
+/**
+ * @brief   Executes an HD44780 instruction or data write.
+ * @param   rs register select, non-zero for data
+ * @param   val instruction or character
+ * @retval  none
+ */
+static void Lcd_Exec(uint8_t rs, uint8_t val) {
+  uint16_t us = HD_EXEC_US;
+
+  lcdDirty = 1;
+  if (rs) {
+    if (!lcd.cgram) {
+      lcd.ddram[lcd.addr] = val;
+      lcd.addr++;
+      if (lcd.lines2) {
+        if (lcd.addr == 0x28) lcd.addr = 0x40;
+        if (lcd.addr == 0x68) lcd.addr = 0x00;
+      } else if (lcd.addr == 0x50) {
+        lcd.addr = 0x00;
+      }
+    }
+  } else if (val & 0x80) {
+    lcd.addr = val & 0x7f;
+    if (lcd.addr >= sizeof(lcd.ddram)) lcd.addr = 0;
+    lcd.cgram = 0;
+  } else if (val & 0x40) {
+    lcd.cgram = 1;
+  } else if (val & 0x20) {
+    lcd.bus8 = (val & 0x10) ? 1 : 0;
+    lcd.lines2 = (val & 0x08) ? 1 : 0;
+    lcd.half = 0;
+  } else if (val & 0x10) {
+    /* --- Cursor and display shift are not modelled --- */
+  } else if (val & 0x08) {
+    lcd.on = (val & 0x04) ? 1 : 0;
+  } else if (val & 0x04) {
+    /* --- Entry mode, the increment without shift is taken --- */
+  } else if (val & 0x02) {
+    lcd.addr = 0;
+    lcd.cgram = 0;
+    us = HD_HOME_US;
+  } else if (val & 0x01) {
+    memset(lcd.ddram, ' ', sizeof(lcd.ddram));
+    lcd.addr = 0;
+    lcd.cgram = 0;
+    us = HD_HOME_US;
+  } else {
+    return;
+  }
+  lcd.busyEnd = Host_Cycles() + US(us);
+}
+
+
+/**
+ * @brief   Renders the visible 16x2 window as text lines.
+ * @param   out buffer of (DSPM_LCD_COLS + 1) * DSPM_LCD_ROWS + 1 chars
+ * @retval  none
+ */
+void DSPM_LcdText(char* out) {
+  for (uint8_t r = 0; r < DSPM_LCD_ROWS; r++) {
+    for (uint8_t c = 0; c < DSPM_LCD_COLS; c++) {
+      uint8_t ch = lcd.ddram[r * 0x40 + c];
+      *out++ = !lcd.on ? ' ' : ((ch >= 0x20) && (ch < 0x7f)) ? (char)ch : '?';
+    }
+    *out++ = '\n';
+  }
+  *out = 0;
+}
+
+
+/* --- SSD1315 block --- */
+
+/**
+ * @brief   A new write transaction begins with a control byte.
+ * @retval  none
+ */
+static void Oled_Start(void) {
+  oled.ctl = 1;
+}
+
+
+/**
+ * @brief   Transaction byte: control byte, command or GDDRAM data. Co = 0
+ *          turns the rest of the transaction into a stream of one kind.
+ * @param   byte the byte
+ * @retval  (uint8_t) 1 = ACK
+ */
+static uint8_t Oled_Write(uint8_t byte) {
+  if (oled.ctl == 1) {
+    oled.data = (byte & _BV(OLED_DC)) ? 1 : 0;
+    oled.ctl = (byte & _BV(OLED_CO)) ? 2 : 0;
+    return 1;
+  }
+
+  if (oled.data) {
+    Oled_Data(byte);
+  } else {
+    Oled_Command(byte);
+  }
+  if (oled.ctl == 2) oled.ctl = 1;
+  oledDirty = 1;
+  return 1;
+}
+
+
+/**
+ * @brief   Command decoder, arguments may come in separate transactions.
+ * @param   byte command or argument byte
+ * @retval  none
+ */
+static void Oled_Command(uint8_t byte) {
+  oled.cmdBytes++;
+
+  if (oled.argNeed) {
+    oled.args[oled.argCnt++] = byte;
+    if (oled.argCnt < oled.argNeed) return;
+    oled.argNeed = 0;
+
+    switch (oled.cmd) {
+      case 0x20:
+        oled.mode = oled.args[0] & 0x03;
+        break;
+      case 0x21:
+        oled.colStart = oled.col = oled.args[0] & 0x7f;
+        oled.colEnd = oled.args[1] & 0x7f;
+        break;
+      case 0x22:
+        oled.pageStart = oled.page = oled.args[0] & 0x07;
+        oled.pageEnd = oled.args[1] & 0x07;
+        break;
+      default:
+        break;
+    }
+    return;
+  }
+
+  /* --- Commands with arguments --- */
+  switch (byte) {
+    case 0x20: case 0x81: case 0x8d: case 0xa8: case 0xd3:
+    case 0xd5: case 0xd9: case 0xda: case 0xdb:
+      oled.argNeed = 1;
+      break;
+    case 0x21: case 0x22: case 0xa3:
+      oled.argNeed = 2;
+      break;
+    case 0x29: case 0x2a:
+      oled.argNeed = 5;
+      break;
+    case 0x26: case 0x27:
+      oled.argNeed = 6;
+      break;
+    default:
+      break;
+  }
+  if (oled.argNeed) {
+    oled.cmd = byte;
+    oled.argCnt = 0;
+    return;
+  }
+
+  if (byte < 0x10) {
+    oled.col = (oled.col & 0xf0) | byte;
+  } else if (byte < 0x20) {
+    oled.col = ((byte & 0x07) << 4) | (oled.col & 0x0f);
+  } else if ((byte & 0xc0) == 0x40) {
+    oled.startLine = byte & 0x3f;
+  } else if ((byte & 0xf8) == 0xb0) {
+    oled.page = byte & 0x07;
+  } else if ((byte & 0xfe) == 0xa0) {
+    oled.remap = byte & 0x01;
+  } else if ((byte & 0xfe) == 0xa4) {
+    oled.allOn = byte & 0x01;
+  } else if ((byte & 0xfe) == 0xa6) {
+    oled.invert = byte & 0x01;
+  } else if ((byte & 0xfe) == 0xae) {
+    oled.on = byte & 0x01;
+  } else if ((byte & 0xf7) == 0xc0) {
+    oled.comRev = (byte & 0x08) ? 1 : 0;
+  }
+}
+
+
+/**
+ * @brief   GDDRAM write and address pointer advance of the current mode.
+ * @param   byte eight vertical pixels, LSB on top
+ * @retval  none
+ */
+static void Oled_Data(uint8_t byte) {
+  oled.dataBytes++;
+  oled.gddram[oled.page][oled.col] = byte;
+
+  switch (oled.mode) {
+    case 0:
+      if (oled.col++ >= oled.colEnd) {
+        oled.col = oled.colStart;
+        if (oled.page++ >= oled.pageEnd) oled.page = oled.pageStart;
+      }
+      break;
+    case 1:
+      if (oled.page++ >= oled.pageEnd) {
+        oled.page = oled.pageStart;
+        if (oled.col++ >= oled.colEnd) oled.col = oled.colStart;
+      }
+      break;
+    default:
+      oled.col = (oled.col + 1) & 0x7f;
+      break;
+  }
+}
+
+
+/**
+ * @brief   Writes the panel picture as a binary PBM, lit pixels are black.
+ *          The glass is taken as on the common 0.96" modules: SEG127 on the
+ *          left and COM63 on top, so the A1/C8 remap shows RAM unflipped.
+ * @param   f output file
+ * @retval  none
+ */
+void DSPM_OledPbm(FILE* f) {
+  const uint8_t h = DSPM_OLED_PAGES * 8;
+
+  fprintf(f, "P4\n%u %u\n", DSPM_OLED_COLS, h);
+  for (uint8_t y = 0; y < h; y++) {
+    uint8_t row = ((oled.comRev ? y : (h - 1 - y)) + oled.startLine) & (h - 1);
+    for (uint8_t x = 0; x < DSPM_OLED_COLS; x += 8) {
+      uint8_t out = 0;
+      for (uint8_t b = 0; b < 8; b++) {
+        uint8_t col = oled.remap ? (x + b) : (DSPM_OLED_COLS - 1 - (x + b));
+        uint8_t px = (oled.gddram[row >> 3][col] >> (row & 0x07)) & 0x01;
+        if (oled.allOn) px = 1;
+        px ^= oled.invert;
+        if (!oled.on) px = 0;
+        out |= px << (7 - b);
+      }
+      fputc(out, f);
+    }
+  }
+}
+
+
+/* --- Capture block --- */
+
+/**
+ * @brief   Stream observer, brackets each firmware printf with the bus
+ *          counters. The I2C queue sends the text after the call returns,
+ *          so the record is written when the next printf begins.
+ * @retval  none
+ */
+static void DSPM_Stream(const char* buf, size_t len, uint8_t done) {
+  if (!done) {
+    DSPM_Record();
+    prnStat = *I2CM_Stat();
+    prnAt = Host_Cycles();
+    return;
+  }
+
+  prnLen = (len < sizeof(prnText)) ? len : sizeof(prnText);
+  memcpy(prnText, buf, prnLen);
+  prnCall = Host_Cycles() - prnAt;
+  prnOpen = 1;
+}
+
+
+/**
+ * @brief   Writes the record of the last printf and the changed frames.
+ * @retval  none
+ */
+static void DSPM_Record(void) {
+  if (!prnOpen) return;
+  prnOpen = 0;
+
+  i2cm_stat_t* s = I2CM_Stat();
+  uint64_t bus = s->busCycles - prnStat.busCycles;
+
+  prnCnt++;
+  if (bus > prnBusMax) prnBusMax = bus;
+  if (!capTxt) return;
+
+  fprintf(capTxt, "# %u t=%.3fms printf=\"", prnCnt, (double)prnAt * 1e3 / F_CPU);
+  for (size_t i = 0; i < prnLen; i++) {
+    if (prnText[i] == '\n') {
+      fputs("\\n", capTxt);
+    } else if (prnText[i] == '\r') {
+      fputs("\\r", capTxt);
+    } else {
+      fputc(prnText[i], capTxt);
+    }
+  }
+  fprintf(capTxt, "\" bytes=%u starts=%u nacks=%u bus_us=%.1f call_us=%.1f\n",
+          s->bytes - prnStat.bytes, s->starts - prnStat.starts, s->nacks - prnStat.nacks,
+          (double)bus * 1e6 / F_CPU, (double)prnCall * 1e6 / F_CPU);
+
+  if (lcdDirty) {
+    char text[(DSPM_LCD_COLS + 1) * DSPM_LCD_ROWS + 1];
+    DSPM_LcdText(text);
+    fputs(text, capTxt);
+    frames++;
+    lcdDirty = 0;
+  }
+
+  if (oledDirty) {
+    char path[DSPM_PATH_MAX];
+    snprintf(path, sizeof(path), "%s_%05u.pbm", capPrefix, prnCnt);
+    FILE* f = fopen(path, "wb");
+    if (f) {
+      DSPM_OledPbm(f);
+      fclose(f);
+      fprintf(capTxt, "oled: %s\n", path);
+      pbms++;
+    }
+    oledDirty = 0;
+  }
+  fflush(capTxt);
+}
+
+
+/**
+ * @brief   End of run report.
+ * @param   out report stream
+ * @retval  (uint8_t) 0, the report does not judge the run
+ */
+static uint8_t DSPM_Report(FILE* out) {
+  DSPM_Record();
+  i2cm_stat_t* s = I2CM_Stat();
+
+  fprintf(out, "dspl: %u printf, %u I2C bytes, %u starts, %u nacks, bus %.1f ms, max %.1f us per printf\n",
+          prnCnt, s->bytes, s->starts, s->nacks, (double)s->busCycles * 1e3 / F_CPU,
+          (double)prnBusMax * 1e6 / F_CPU);
+  fprintf(out, "dspl: wh1602 %u busy hits, ssd1315 %u cmd / %u data bytes, %u text / %u pbm frames\n",
+          lcd.busyHits, oled.cmdBytes, oled.dataBytes, frames, pbms);
+  fprintf(out, "dspl: SCL low/high min wh1602 %.0f/%.0f ns, ssd1315 %.0f/%.0f ns, %u/%u clocks over the rating\n",
+          DSPM_Ns(s->minLow[DSPM_LCD_DEV]), DSPM_Ns(s->minHigh[DSPM_LCD_DEV]),
+          DSPM_Ns(s->minLow[DSPM_OLED_DEV]), DSPM_Ns(s->minHigh[DSPM_OLED_DEV]),
+          s->fast[DSPM_LCD_DEV], s->fast[DSPM_OLED_DEV]);
+  if (capTxt) fclose(capTxt);
+  return 0;
+}
+
+
+/**
+ * @brief   Cycles in nanoseconds.
+ * @param   c cycles
+ * @retval  (double) nanoseconds
+ */
+static double DSPM_Ns(uint32_t c) {
+  return (double)c * 1e9 / F_CPU;
+}
+
+
+/* Getters */
+dspm_lcd_t* DSPM_Lcd(void) {
+  return &lcd;
+}
+
+dspm_oled_t* DSPM_Oled(void) {
+  return &oled;
+}
@@ -0,0 +1,792 @@
+/*
+ * Filename: hal.c
+ * Description: The host-native build HAL. Emulates the ATTiny85 registers,
+ *              Timer0, Timer1, the watchdog, EEPROM, the USI two-wire
+ *              shifter and the pin change interrupt, and calls ISR bodies
+ *              from a simulated clock.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:12:40 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+#define _GNU_SOURCE
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <signal.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+/* --- The firmware sees a read-only view of the register page, its first --- */
+/* --- write faults, is let through and settled on the next access --- */
+/* --- Registers where writing the old value has an effect are trapped, --- */
+/* --- the rest are written straight through and found by value --- */
+#define HOST_TRAPPED(r) (((r) == HR_PINB) || ((r) == HR_USISR) || ((r) == HR_TIFR) || \
+                         ((r) == HR_GIFR) || ((r) == HR_EECR) || ((r) == HR_WDTCR))
+
+#define HOST_BUS_MAX    4
+#define HOST_HOOK_MAX   4
+#define HOST_EE_SIZE    (E2END + 1)
+#define HOST_EE_CYCLES  (F_CPU / 1000000UL * 3400) // 3.4 ms write
+#define HOST_WDT_CYCLES (F_CPU / 1000UL * 16)      // 16 ms at WDP = 0
+#define HOST_SLEEP_STEP 16
+#define HOST_PIN_STEP   (F_CPU / 1000000UL) // line check period of a traced spin, 1 us
+#define HOST_VECTORS    15
+
+#define I2C_SDA         PB0
+#define I2C_SCL         PB2
+
+/* Vectors the firmware may not define */
+#define HOST_WEAK_VECTOR(n) void __vector_##n(void) __attribute__((weak))
+HOST_WEAK_VECTOR(1);  HOST_WEAK_VECTOR(2);  HOST_WEAK_VECTOR(3);
+HOST_WEAK_VECTOR(4);  HOST_WEAK_VECTOR(5);  HOST_WEAK_VECTOR(6);
+HOST_WEAK_VECTOR(7);  HOST_WEAK_VECTOR(8);  HOST_WEAK_VECTOR(9);
+HOST_WEAK_VECTOR(10); HOST_WEAK_VECTOR(11); HOST_WEAK_VECTOR(12);
+HOST_WEAK_VECTOR(13); HOST_WEAK_VECTOR(14);
+
+/* Private variables */
+static uint8_t*           regRw;            // HAL view of the register page
+static volatile uint8_t*  regRo;            // firmware view, write-protected
+static long               regPage;
+static volatile int16_t   regWritten = -1;  // register written since the last settle
+static uint8_t            regShadow[HR_COUNT];
+static volatile uint8_t*  regView[HR_COUNT];  // per register firmware view
+
+static uint64_t           cycles   = 0;
+static uint64_t           runLimit = 0;
+static uint32_t           t0Pre    = 0;
+static uint32_t           t1Pre    = 0;
+static uint64_t           wdtDue   = 0;
+static uint64_t           eeBusy   = 0;
+static uint8_t            eeprom[HOST_EE_SIZE];
+static const char*        eeFile   = NULL;
+static uint8_t            inIsr    = 0;  // ISRs running, an ISR that sets I lets others in
+static uint32_t           isrCnt[HOST_VECTORS];
+static uint32_t           eeWrites = 0;
+static struct timespec    wallStart;
+
+static host_bus_t         bus[HOST_BUS_MAX];
+static uint8_t            busCnt = 0;
+static host_bus_t         busOwner = NULL;  // device that owns the overridden lines
+static uint8_t            busOverride = 0;
+static host_stream_t      streams[HOST_HOOK_MAX];
+static uint8_t            streamCnt = 0;
+static host_report_t      reports[HOST_HOOK_MAX];
+static uint8_t            reportCnt = 0;
+static uint8_t            usiLatch = 0x80;  // two-wire SDA output latch
+static host_sample_t      sampler  = NULL;
+static uint64_t           sampleEvery = 0;
+static uint64_t           sampleNext  = 0;
+static FILE*              hostOut;
+
+/* Private function definitions */
+static void Host_Init(void) __attribute__((constructor(HOST_INIT_HAL)));
+static void Host_Fault(int, siginfo_t*, void*);
+static void Host_Settle(void);
+static void Host_Write(uint8_t, uint8_t, uint8_t);
+static void Host_Pins(void);
+static void Host_UsiStrobe(void);
+static void Host_Timers(uint32_t);
+static uint16_t Host_T0Div(void);
+static uint32_t Host_T0Match(uint8_t, uint8_t);
+static uint32_t Host_T1Div(void);
+static uint32_t Host_NextEvent(void);
+static uint8_t Host_Dispatch(void);
+static void Host_Exit(int);
+static ssize_t Host_StreamWrite(void*, const char*, size_t);
+
+
+
+/**
+ * @brief   Sets up the register page, the emulated memories and the run
+ *          limit before the firmware main() starts.
+ * @retval  none
+ */
+static void Host_Init(void) {
+  regPage = sysconf(_SC_PAGESIZE);
+
+  /* --- Two views of one page, the HAL writes freely, the firmware traps --- */
+  int fd = memfd_create("sml-regs", 0);
+  if ((fd < 0) || (ftruncate(fd, regPage) < 0)) abort();
+  regRw = mmap(NULL, regPage, PROT_READ|PROT_WRITE, MAP_SHARED, fd, 0);
+  regRo = mmap(NULL, regPage, PROT_READ, MAP_SHARED, fd, 0);
+  if ((regRw == MAP_FAILED) || (regRo == MAP_FAILED)) abort();
+  close(fd);
+
+  struct sigaction sa;
+  memset(&sa, 0, sizeof(sa));
+  sa.sa_sigaction = Host_Fault;
+  sa.sa_flags = SA_SIGINFO|SA_NODEFER;
+  sigaction(SIGSEGV, &sa, NULL);
+
+  /* --- Reset values --- */
+  regRw[HR_MCUSR] = _BV(PORF);
+  regRw[HR_PINB] = 0x3f;
+  memcpy(regShadow, regRw, HR_COUNT);
+  for (uint8_t i = 0; i < HR_COUNT; i++) {
+    regView[i] = HOST_TRAPPED(i) ? &regRo[i] : &regRw[i];
+  }
+
+  memset(eeprom, 0xff, sizeof(eeprom));
+  eeFile = getenv(HOST_ENV_EEPROM);
+  if (eeFile) {
+    FILE* f = fopen(eeFile, "rb");
+    if (f) {
+      if (fread(eeprom, 1, sizeof(eeprom), f)) {};
+      fclose(f);
+    }
+  }
+
+  const char* ms = getenv(HOST_ENV_MS);
+  uint32_t runMs = ms ? (uint32_t)strtoul(ms, NULL, 10) : HOST_RUN_MS;
+  runLimit = (uint64_t)runMs * (F_CPU / 1000);
+
+  hostOut = stdout;
+  clock_gettime(CLOCK_MONOTONIC, &wallStart);
+}
+
+
+/**
+ * @brief   Catches the firmware write into the register page, records the
+ *          register and lets the write go through.
+ * @retval  none
+ */
+static void Host_Fault(int sig, siginfo_t* si, void* ctx) {
+  uint8_t* addr = (uint8_t*)si->si_addr;
+  (void)ctx;
+
+  if ((addr >= (uint8_t*)regRo) && (addr < (uint8_t*)regRo + regPage)) {
+    regWritten = (int16_t)(addr - (uint8_t*)regRo);
+    mprotect((void*)regRo, regPage, PROT_READ|PROT_WRITE);
+    return;
+  }
+  signal(sig, SIG_DFL);
+  raise(sig);
+}
+
+
+/**
+ * @brief   Gives the firmware a register, settles the previous write and
+ *          spends one cycle.
+ * @param   reg register index
+ * @retval  (volatile uint8_t*) pointer to the register
+ */
+volatile uint8_t* Host_Reg(uint8_t reg) {
+  Host_Settle();
+  Host_Advance(1);
+
+  /* --- Devices may change the lines on their own timing --- */
+  if ((reg == HR_PINB) && busCnt) {
+    Host_Pins();
+    regShadow[HR_PINB] = regRw[HR_PINB];
+  }
+  return regView[reg];
+}
+
+
+/**
+ * @brief   Applies side effects of the last firmware write.
+ * @retval  none
+ */
+static void Host_Settle(void) {
+  uint8_t reg[2], val[2], old[2];
+  uint8_t n = 0;
+
+  /* --- Written through, a 16-bit write changes two registers --- */
+  for (uint8_t i = 0; (i < HR_COUNT) && (n < 2); i++) {
+    if (!HOST_TRAPPED(i) && (regRw[i] != regShadow[i])) {
+      reg[n] = i;
+      val[n] = regRw[i];
+      old[n++] = regShadow[i];
+    }
+  }
+  for (uint8_t i = 0; i < n; i++) Host_Write(reg[i], val[i], old[i]);
+
+  if (regWritten < 0) return;
+  uint8_t r = (uint8_t)regWritten;
+  regWritten = -1;
+  mprotect((void*)regRo, regPage, PROT_READ);
+  Host_Write(r, regRw[r], regShadow[r]);
+}
+
+
+/**
+ * @brief   Emulates a register write.
+ * @param   reg register index
+ * @param   val written value
+ * @param   old value before the write
+ * @retval  none
+ */
+static void Host_Write(uint8_t reg, uint8_t val, uint8_t old) {
+  switch (reg) {
+    case HR_PINB:
+      /* --- Writing ones to PINB toggles PORTB --- */
+      regRw[HR_PORTB] ^= val;
+      break;
+
+    case HR_USISR:
+      /* --- Flags are cleared by writing one, USIDC is read-only --- */
+      regRw[HR_USISR] = (old & 0xe0 & ~val) | (old & _BV(USIDC)) | (val & 0x0f);
+      break;
+
+    case HR_USICR:
+      regRw[HR_USICR] = val & ~_BV(USITC);
+      if (val & _BV(USITC)) Host_UsiStrobe();
+      break;
+
+    case HR_EECR:
+      if (val & _BV(EERE)) {
+        regRw[HR_EEDR] = eeprom[(regRw[HR_EEARL] | (regRw[HR_EEARH] << 8)) % HOST_EE_SIZE];
+      }
+      if ((val & _BV(EEPE)) && (old & _BV(EEMPE)) && (cycles >= eeBusy)) {
+        uint16_t addr = (regRw[HR_EEARL] | (regRw[HR_EEARH] << 8)) % HOST_EE_SIZE;
+        switch (val & (_BV(EEPM1)|_BV(EEPM0))) {
+          case _BV(EEPM0): eeprom[addr] = 0xff; break;
+          case _BV(EEPM1): eeprom[addr] &= regRw[HR_EEDR]; break;
+          default: eeprom[addr] = regRw[HR_EEDR]; break;
+        }
+        eeBusy = cycles + HOST_EE_CYCLES;
+        eeWrites++;
+      }
+      if (val & _BV(EEPE)) val &= ~_BV(EEMPE);
+      regRw[HR_EECR] = (val & ~(_BV(EERE)|_BV(EEPE))) | ((cycles < eeBusy) ? _BV(EEPE) : 0);
+      break;
+
+    case HR_WDTCR:
+      regRw[HR_WDTCR] = (val & ~_BV(WDIF)) | (old & _BV(WDIF) & ~val);
+      Host_WdtReset();
+      break;
+
+    case HR_TIFR:
+    case HR_GIFR:
+      regRw[reg] = old & ~val;
+      break;
+
+    case HR_GTCCR:
+      /* --- Prescaler resets, held while TSM is set --- */
+      if (val & _BV(PSR0)) t0Pre = 0;
+      if (val & _BV(PSR1)) t1Pre = 0;
+      if (!(val & _BV(TSM))) regRw[HR_GTCCR] = val & ~(_BV(PSR0)|_BV(PSR1));
+      break;
+
+    default:
+      break;
+  }
+
+  Host_Pins();
+  memcpy(regShadow, regRw, HR_COUNT);
+}
+
+
+/**
+ * @brief   Resolves PORTB pin levels: open drain lines with pull-ups, the
+ *          MCU output drivers, USI two-wire SDA and attached devices.
+ *          The SDA output latch follows USIDR only while SCL is low, so the
+ *          shift on the rising edge does not move SDA under a high SCL.
+ * @retval  none
+ */
+static void Host_Pins(void) {
+  uint8_t ddr = regRw[HR_DDRB];
+  uint8_t drive = ddr & ~regRw[HR_PORTB];
+
+  if (drive & _BV(I2C_SCL)) usiLatch = regRw[HR_USIDR] & 0x80;
+  if ((regRw[HR_USICR] & _BV(USIWM1)) && (ddr & _BV(I2C_SDA)) && !usiLatch) {
+    drive |= _BV(I2C_SDA);
+  }
+
+  uint8_t strong = ddr & regRw[HR_PORTB] & ~drive;
+  uint8_t pins = ~drive & 0x3f;
+  for (uint8_t i = 0; i < busCnt; i++) {
+    uint8_t pull = bus[i](drive, strong, pins);
+    if (bus[i] != busOwner) pull &= ~busOverride;
+    pins &= ~pull;
+  }
+
+  /* --- Pin change interrupt flag, PCMSK selects the lines --- */
+  if ((pins ^ regRw[HR_PINB]) & regRw[HR_PCMSK]) {
+    regRw[HR_GIFR] |= _BV(PCIF);
+    regShadow[HR_GIFR] = regRw[HR_GIFR];
+  }
+  regRw[HR_PINB] = pins;
+}
+
+
+/**
+ * @brief   USI software clock strobe: toggles SCL, counts the edge and
+ *          shifts in SDA on the rising one.
+ * @retval  none
+ */
+static void Host_UsiStrobe(void) {
+  regRw[HR_PORTB] ^= _BV(I2C_SCL);
+  Host_Pins();
+
+  if (regRw[HR_PINB] & _BV(I2C_SCL)) {
+    regRw[HR_USIDR] = (regRw[HR_USIDR] << 1) | ((regRw[HR_PINB] >> I2C_SDA) & 0x01);
+    regRw[HR_USIBR] = regRw[HR_USIDR];
+  }
+
+  uint8_t cnt = (regRw[HR_USISR] + 1) & 0x0f;
+  regRw[HR_USISR] = (regRw[HR_USISR] & 0xf0) | cnt;
+  if (!cnt) regRw[HR_USISR] |= _BV(USIOIF);
+  Host_Pins();
+}
+
+
+/**
+ * @brief   Runs the simulated clock.
+ * @param   n cycles to spend
+ * @retval  (uint8_t) number of ISRs dispatched
+ */
+uint8_t Host_Advance(uint32_t n) {
+  Host_Settle();
+  cycles += n;
+  Host_Timers(n);
+
+  if (sampler && (cycles >= sampleNext)) {
+    uint64_t k = (cycles - sampleNext) / sampleEvery + 1;
+    sampleNext += k * sampleEvery;
+    sampler((uint32_t)k);
+  }
+
+  if (runLimit && (cycles >= runLimit) && !inIsr) Host_Exit(HOST_EXIT_DONE);
+  return Host_Dispatch();
+}
+
+
+/**
+ * @brief   Timer0 clock divider.
+ * @retval  (uint16_t) cycles per count, 0 = stopped
+ */
+static uint16_t Host_T0Div(void) {
+  static const uint16_t div0[8] = {0, 1, 8, 64, 256, 1024, 0, 0};
+
+  if (regRw[HR_PRR] & _BV(PRTIM0)) return 0;
+  if ((regRw[HR_GTCCR] & _BV(TSM)) && (regRw[HR_GTCCR] & _BV(PSR0))) return 0;
+  return div0[regRw[HR_TCCR0B] & 0x07];
+}
+
+
+/**
+ * @brief   Timer0 counts until the counter leaves the given value, which
+ *          is when the compare match flag is set.
+ * @param   tcnt counter now
+ * @param   ocr compare value
+ * @retval  (uint32_t) counts, 1 = on the next one
+ */
+static uint32_t Host_T0Match(uint8_t tcnt, uint8_t ocr) {
+  uint8_t ctc = regRw[HR_TCCR0A] & _BV(WGM01);
+  uint8_t top = regRw[HR_OCR0A];
+  uint32_t cnt = 1;
+
+  /* --- In CTC a value over the top comes after the wrap, if at all --- */
+  while ((tcnt != ocr) && (cnt <= 512)) {
+    tcnt = (ctc && (tcnt == top)) ? 0 : (uint8_t)(tcnt + 1);
+    cnt++;
+  }
+  return cnt;
+}
+
+
+/**
+ * @brief   Timer1 clock divider.
+ * @retval  (uint32_t) cycles per count, 0 = stopped
+ */
+static uint32_t Host_T1Div(void) {
+  uint8_t cs1 = regRw[HR_TCCR1] & 0x0f;
+
+  if (!cs1 || (regRw[HR_PRR] & _BV(PRTIM1))) return 0;
+  if ((regRw[HR_GTCCR] & _BV(TSM)) && (regRw[HR_GTCCR] & _BV(PSR1))) return 0;
+  return 1UL << (cs1 - 1);
+}
+
+
+/**
+ * @brief   Cycles to the next timer, watchdog or EEPROM event, the sleeping
+ *          core skips straight to it.
+ * @retval  (uint32_t) cycles, at least one sleep step
+ */
+static uint32_t Host_NextEvent(void) {
+  uint64_t next = UINT32_MAX;
+
+  uint16_t d = Host_T0Div();
+  if (d) {
+    uint8_t tcnt = regRw[HR_TCNT0];
+    uint8_t ocr = regRw[HR_OCR0A];
+    uint32_t cnt = (uint8_t)(ocr - tcnt);
+    if (!cnt) cnt = 256;
+    if (!(regRw[HR_TCCR0A] & _BV(WGM01))) {
+      if (256U - tcnt < cnt) cnt = 256U - tcnt;
+    } else if (tcnt <= ocr) {
+      cnt = (uint32_t)(ocr - tcnt) + 1;
+    }
+    next = (uint64_t)cnt * d - t0Pre;
+
+    if (regRw[HR_TIMSK] & _BV(OCIE0B)) {
+      uint64_t b = (uint64_t)Host_T0Match(tcnt, regRw[HR_OCR0B]) * d - t0Pre;
+      if (b < next) next = b;
+    }
+  }
+
+  uint32_t d1 = Host_T1Div();
+  if (d1) {
+    uint64_t t1 = (uint64_t)(256U - regRw[HR_TCNT1]) * d1 - t1Pre;
+    if (t1 < next) next = t1;
+  }
+
+  if ((regRw[HR_WDTCR] & (_BV(WDE)|_BV(WDIE))) && (wdtDue > cycles) && (wdtDue - cycles < next)) {
+    next = wdtDue - cycles;
+  }
+  if ((regRw[HR_EECR] & _BV(EEPE)) && (eeBusy > cycles) && (eeBusy - cycles < next)) {
+    next = eeBusy - cycles;
+  }
+  if (runLimit && (runLimit > cycles) && (runLimit - cycles < next)) {
+    next = runLimit - cycles;
+  }
+  return (next < HOST_SLEEP_STEP) ? HOST_SLEEP_STEP : (uint32_t)next;
+}
+
+
+/**
+ * @brief   Steps Timer0 (CTC or normal), Timer1, the watchdog and the
+ *          EEPROM write timer. Counts are applied in bulk, a long sleep
+ *          costs the same as a short one.
+ * @param   n cycles spent
+ * @retval  none
+ */
+static void Host_Timers(uint32_t n) {
+  uint16_t d = Host_T0Div();
+  if (d) {
+    t0Pre += n;
+    uint32_t cnt = t0Pre / d;
+    t0Pre %= d;
+
+    uint8_t tcnt = regRw[HR_TCNT0];
+    uint8_t ocr = regRw[HR_OCR0A];
+    if (cnt && (cnt >= Host_T0Match(tcnt, regRw[HR_OCR0B]))) regRw[HR_TIFR] |= _BV(OCF0B);
+    if (regRw[HR_TCCR0A] & _BV(WGM01)) {
+      /* --- CTC, past the top the counter runs up to the wrap first --- */
+      if ((tcnt > ocr) && (cnt >= 256U - tcnt)) {
+        cnt -= 256U - tcnt;
+        tcnt = 0;
+      }
+      /* --- The match clears the counter, a period is OCR0A + 1 counts --- */
+      uint32_t left = (uint32_t)(ocr - tcnt) + 1;
+      if ((tcnt <= ocr) && (cnt >= left)) {
+        regRw[HR_TIFR] |= _BV(OCF0A);
+        tcnt = (uint8_t)((cnt - left) % ((uint32_t)ocr + 1));
+      } else {
+        tcnt += (uint8_t)cnt;
+      }
+    } else {
+      uint32_t toOcr = (uint8_t)(ocr - tcnt);
+      if (!toOcr) toOcr = 256;
+      if (cnt >= toOcr) regRw[HR_TIFR] |= _BV(OCF0A);
+      if (cnt >= 256U - tcnt) regRw[HR_TIFR] |= _BV(TOV0);
+      tcnt += (uint8_t)cnt;
+    }
+    regRw[HR_TCNT0] = tcnt;
+  }
+
+  uint32_t d1 = Host_T1Div();
+  if (d1) {
+    t1Pre += n;
+    uint32_t cnt = t1Pre / d1;
+    t1Pre %= d1;
+    if (cnt >= 256U - regRw[HR_TCNT1]) regRw[HR_TIFR] |= _BV(TOV1);
+    regRw[HR_TCNT1] = (uint8_t)(regRw[HR_TCNT1] + cnt);
+  }
+
+  uint8_t wdt = regRw[HR_WDTCR];
+  if ((wdt & (_BV(WDE)|_BV(WDIE))) && (cycles >= wdtDue)) {
+    if (wdt & _BV(WDIE)) {
+      regRw[HR_WDTCR] |= _BV(WDIF);
+      Host_WdtReset();
+    } else {
+      fprintf(stderr, "host: watchdog reset at %llu ms\n",
+              (unsigned long long)(cycles / (F_CPU / 1000)));
+      Host_Exit(HOST_EXIT_WDR);
+    }
+  }
+
+  if ((regRw[HR_EECR] & _BV(EEPE)) && (cycles >= eeBusy)) {
+    regRw[HR_EECR] &= ~_BV(EEPE);
+  }
+
+  memcpy(regShadow, regRw, HR_COUNT);
+}
+
+
+/**
+ * @brief   Calls the highest priority pending ISR with interrupts enabled.
+ *          Like the core, an ISR that enables interrupts can be interrupted.
+ * @retval  (uint8_t) number of ISRs dispatched
+ */
+static uint8_t Host_Dispatch(void) {
+  uint8_t done = 0;
+
+  while (regRw[HR_SREG] & _BV(SREG_I)) {
+    void (*isr)(void) = NULL;
+    uint8_t vec = 0;
+    uint8_t tifr = regRw[HR_TIFR] & regRw[HR_TIMSK];
+
+    if (regRw[HR_GIFR] & regRw[HR_GIMSK] & _BV(PCIF)) {
+      regRw[HR_GIFR] &= ~_BV(PCIF);
+      isr = __vector_2; vec = 2;
+    } else if (tifr & _BV(TOV1)) {
+      regRw[HR_TIFR] &= ~_BV(TOV1);
+      isr = __vector_4; vec = 4;
+    } else if (tifr & _BV(TOV0)) {
+      regRw[HR_TIFR] &= ~_BV(TOV0);
+      isr = __vector_5; vec = 5;
+    } else if ((regRw[HR_EECR] & _BV(EERIE)) && !(regRw[HR_EECR] & _BV(EEPE))) {
+      isr = __vector_6; vec = 6;
+    } else if (tifr & _BV(OCF0A)) {
+      regRw[HR_TIFR] &= ~_BV(OCF0A);
+      isr = __vector_10; vec = 10;
+    } else if (tifr & _BV(OCF0B)) {
+      regRw[HR_TIFR] &= ~_BV(OCF0B);
+      isr = __vector_11; vec = 11;
+    } else if ((regRw[HR_WDTCR] & (_BV(WDIF)|_BV(WDIE))) == (_BV(WDIF)|_BV(WDIE))) {
+      /* --- In interrupt and reset mode the next time-out resets --- */
+      regRw[HR_WDTCR] &= ~_BV(WDIF);
+      if (regRw[HR_WDTCR] & _BV(WDE)) regRw[HR_WDTCR] &= ~_BV(WDIE);
+      isr = __vector_12; vec = 12;
+    } else {
+      break;
+    }
+    memcpy(regShadow, regRw, HR_COUNT);
+
+    isrCnt[vec]++;
+    done++;
+    if (isr) {
+      inIsr++;
+      regRw[HR_SREG] &= ~_BV(SREG_I);
+      regShadow[HR_SREG] = regRw[HR_SREG];
+      isr();
+      Host_Settle();
+      regRw[HR_SREG] |= _BV(SREG_I);
+      regShadow[HR_SREG] = regRw[HR_SREG];
+      inIsr--;
+    }
+  }
+  return done;
+}
+
+
+/**
+ * @brief   Spends a busy-wait in steps between timer events, so a long spin
+ *          costs a few calls and no ISR is served late. With the pin change
+ *          interrupt on, the lines are checked every microsecond, so device
+ *          edges inside the wait are seen on time.
+ * @param   n cycles to spend
+ * @retval  none
+ */
+void Host_Spin(uint32_t n) {
+  uint8_t traced = busCnt && (regRw[HR_GIMSK] & _BV(PCIE)) && regRw[HR_PCMSK];
+
+  while (n) {
+    uint32_t step = Host_NextEvent();
+    if (traced && (step > HOST_PIN_STEP)) step = HOST_PIN_STEP;
+    if (step > n) step = n;
+    if (traced) Host_Pins();
+    Host_Advance(step);
+    n -= step;
+  }
+}
+
+
+/**
+ * @brief   Sleeps the core: runs the clock until an interrupt is served.
+ * @retval  none
+ */
+void Host_Sleep(void) {
+  Host_Settle();
+  if (!(regRw[HR_MCUCR] & _BV(SE)) || !(regRw[HR_SREG] & _BV(SREG_I))) return;
+  while (!Host_Advance(Host_NextEvent()));
+}
+
+
+/**
+ * @brief   Disables interrupts.
+ * @retval  none
+ */
+void Host_Cli(void) {
+  Host_Settle();
+  regRw[HR_SREG] &= ~_BV(SREG_I);
+  regShadow[HR_SREG] = regRw[HR_SREG];
+}
+
+
+/**
+ * @brief   Enables interrupts. Like SEI, pending ones are served after the
+ *          next instruction, i.e. on the next clock step.
+ * @retval  none
+ */
+void Host_Sei(void) {
+  Host_Settle();
+  regRw[HR_SREG] |= _BV(SREG_I);
+  regShadow[HR_SREG] = regRw[HR_SREG];
+}
+
+
+/**
+ * @brief   Restarts the watchdog time-out.
+ * @retval  none
+ */
+void Host_WdtReset(void) {
+  uint8_t w = regRw[HR_WDTCR];
+  uint8_t wdp = (w & 0x07) | ((w & _BV(WDP3)) ? 0x08 : 0);
+  wdtDue = cycles + ((uint64_t)HOST_WDT_CYCLES << wdp);
+}
+
+
+/**
+ * @brief   Gives the simulated clock.
+ * @retval  (uint64_t) cycles since reset
+ */
+uint64_t Host_Cycles(void) {
+  return cycles;
+}
+
+
+/**
+ * @brief   Sets the simulated run length.
+ * @param   ms run length from reset, ms, 0 = endless
+ * @retval  none
+ */
+void Host_SetRunLimit(uint32_t ms) {
+  runLimit = (uint64_t)ms * (F_CPU / 1000);
+}
+
+
+/**
+ * @brief   Attaches a device model to PORTB.
+ * @param   hook device line resolver
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t Host_AddBus(host_bus_t hook) {
+  if (busCnt >= HOST_BUS_MAX) return 1;
+  bus[busCnt++] = hook;
+  Host_Pins();
+  memcpy(regShadow, regRw, HR_COUNT);
+  return 0;
+}
+
+
+/**
+ * @brief   Gives lines to one device, the pulls of the others on them are
+ *          ignored from the next line update on. Used to replay a capture
+ *          over the running models, may be called from a bus hook.
+ * @param   hook owner, an attached device
+ * @param   pins lines taken over, 0 gives them back
+ * @retval  none
+ */
+void Host_Override(host_bus_t hook, uint8_t pins) {
+  busOwner = hook;
+  busOverride = pins;
+}
+
+
+/**
+ * @brief   Attaches a firmware output stream observer.
+ * @param   hook stream observer
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t Host_AddStream(host_stream_t hook) {
+  if (streamCnt >= HOST_HOOK_MAX) return 1;
+  streams[streamCnt++] = hook;
+  return 0;
+}
+
+
+/**
+ * @brief   Attaches a model report to the end of the run.
+ * @param   hook report writer
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t Host_AddReport(host_report_t hook) {
+  if (reportCnt >= HOST_HOOK_MAX) return 1;
+  reports[reportCnt++] = hook;
+  return 0;
+}
+
+
+/**
+ * @brief   Sets the clock sampler up, one at a time.
+ * @param   hook sampler, NULL to stop sampling
+ * @param   every sample period, cycles
+ * @retval  none
+ */
+void Host_SetSampler(host_sample_t hook, uint32_t every) {
+  sampleEvery = every ? every : 1;
+  sampleNext = cycles + sampleEvery;
+  sampler = hook;
+}
+
+
+/**
+ * @brief   Ends the run: saves EEPROM and prints the run report.
+ * @param   code process exit code
+ * @retval  none
+ */
+static void Host_Exit(int code) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  double wall = (now.tv_sec - wallStart.tv_sec) * 1e3 + (now.tv_nsec - wallStart.tv_nsec) / 1e6;
+  double sim = (double)cycles / (F_CPU / 1000);
+
+  if (eeFile) {
+    FILE* f = fopen(eeFile, "wb");
+    if (f) {
+      fwrite(eeprom, 1, sizeof(eeprom), f);
+      fclose(f);
+    }
+  }
+
+  fflush(hostOut);
+  fprintf(stderr, "host: %.0f ms simulated in %.1f ms (x%.1f), %u EEPROM writes\n",
+          sim, wall, (wall > 0) ? sim / wall : 0.0, eeWrites);
+  for (uint8_t i = 0; i < HOST_VECTORS; i++) {
+    if (isrCnt[i]) fprintf(stderr, "host: vector %2u: %u\n", i, isrCnt[i]);
+  }
+  for (uint8_t i = 0; i < reportCnt; i++) {
+    if (reports[i](stderr) && (code == HOST_EXIT_DONE)) code = HOST_EXIT_FAIL;
+  }
+  _exit(code);
+}
+
+
+/**
+ * @brief   Host side of an avr-libc output stream, every character goes to
+ *          the firmware putc and is echoed on the host standard output.
+ * @retval  (ssize_t) number of bytes taken
+ */
+static ssize_t Host_StreamWrite(void* cookie, const char* buf, size_t len) {
+  int (*put)(char, FILE*) = (int (*)(char, FILE*))cookie;
+
+  for (uint8_t i = 0; i < streamCnt; i++) streams[i](buf, len, 0);
+  for (size_t i = 0; i < len; i++) {
+    put(buf[i], NULL);
+    fputc(buf[i], hostOut);
+  }
+  fflush(hostOut);
+  for (uint8_t i = 0; i < streamCnt; i++) streams[i](buf, len, 1);
+  return (ssize_t)len;
+}
+
+
+/**
+ * @brief   Opens a write stream over a firmware putc.
+ * @param   put firmware character output
+ * @retval  (FILE*) the stream
+ */
+FILE* Host_FdevOpen(int (*put)(char, FILE*)) {
+  cookie_io_functions_t io = {NULL, Host_StreamWrite, NULL, NULL};
+  FILE* f = fopencookie((void*)put, "w", io);
+  setvbuf(f, NULL, _IONBF, 0);
+  return f;
+}
@@ -0,0 +1,274 @@
+/*
+ * Filename: i2c_model.c
+ * Description: The simulated I2C bus on PB0 (SDA) and PB2 (SCL). Follows the
+ *              MCU line edges: START/STOP, address and data bytes, and gives
+ *              the ACK of the addressed slave model on the ninth clock.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 10:05:12 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include "i2c_model.h"
+
+
+/* --- Bus states --- */
+#define S_IDLE          0 // waits for a START
+#define S_ADDR          1
+#define S_DATA          2
+#define S_IGNORE        3 // someone else is addressed, or a read
+
+
+/* Private variables */
+static const i2cm_dev_t*  dev[I2CM_MAX_DEV];
+static uint8_t            devCnt   = 0;
+static const i2cm_dev_t*  cur      = NULL;
+static uint8_t            curIdx   = 0;
+static uint32_t           limLow[I2CM_MAX_DEV];   // rated minimums, cycles
+static uint32_t           limHigh[I2CM_MAX_DEV];
+static i2cm_stat_t        stat;
+static uint8_t            attached = 0;
+
+static uint8_t            state    = S_IDLE;
+static uint8_t            sclPrev  = 1;
+static uint8_t            sdaPrev  = 1;
+static uint8_t            clocks   = 0;   // rising edges in the current byte frame
+static uint8_t            shift    = 0;
+static uint8_t            ack      = 0;   // the slave pulls SDA
+static uint64_t           startAt  = 0;
+static uint64_t           riseAt   = 0;   // last SCL edges
+static uint64_t           fallAt   = 0;
+
+/* --- Injected faults --- */
+static uint64_t           sclHold  = 0;   // SCL pulled low till this cycle
+static uint8_t            sdaStuck = 0;   // SCL rises SDA stays pulled low for
+static uint8_t            gone     = 0;   // unplugged slaves, a bit per model
+
+/* Private function definitions */
+static uint8_t I2CM_Bus(uint8_t, uint8_t, uint8_t);
+static void I2CM_Start(uint64_t);
+static void I2CM_Stop(uint64_t);
+static uint8_t I2CM_Byte(uint8_t);
+static void I2CM_Clock(uint8_t, uint32_t);
+
+
+
+/**
+ * @brief   Adds a slave model and hooks the bus on the first call.
+ * @param   d slave model
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t I2CM_AddDevice(const i2cm_dev_t* d) {
+  /* --- UM10204 tLOW and tHIGH of the slave's mode, ns --- */
+  uint32_t low = (d->maxHz <= 100000) ? 4700 : (d->maxHz <= 400000) ? 1300 : 500;
+  uint32_t high = (d->maxHz <= 100000) ? 4000 : (d->maxHz <= 400000) ? 600 : 260;
+
+  if (devCnt >= I2CM_MAX_DEV) return 1;
+  limLow[devCnt] = d->maxHz ? (uint32_t)(((uint64_t)low * F_CPU + 999999999ULL) / 1000000000ULL) : 0;
+  limHigh[devCnt] = d->maxHz ? (uint32_t)(((uint64_t)high * F_CPU + 999999999ULL) / 1000000000ULL) : 0;
+  dev[devCnt++] = d;
+  if (!attached) {
+    Host_AddBus(I2CM_Bus);
+    attached = 1;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Bus hook, follows the MCU edges on SDA and SCL and gives the ACK
+ *          pull. SDA changes under a low SCL are data setup, under a high
+ *          SCL they are START and STOP.
+ * @retval  (uint8_t) lines pulled low
+ */
+static uint8_t I2CM_Bus(uint8_t drive, uint8_t strong, uint8_t pins) {
+  uint64_t now = Host_Cycles();
+  uint8_t scl = !(drive & _BV(I2CM_SCL));
+  uint8_t sda = !(drive & _BV(I2CM_SDA));
+  (void)strong;
+  (void)pins;
+
+  /* --- A faulted bus carries no protocol, the next START begins anew --- */
+  if ((now < sclHold) || sdaStuck) {
+    if (scl && !sclPrev && sdaStuck) sdaStuck--;
+    state = S_IDLE;
+    cur = NULL;
+    clocks = 0;
+    ack = 0;
+    sclPrev = scl;
+    sdaPrev = sda;
+    return ((now < sclHold) ? _BV(I2CM_SCL) : 0) | (sdaStuck ? _BV(I2CM_SDA) : 0);
+  }
+
+  if (scl && sclPrev && (sda != sdaPrev)) {
+    if (sda) {
+      I2CM_Stop(now);
+    } else {
+      I2CM_Start(now);
+    }
+  } else if (scl && !sclPrev) {
+    if (state == S_DATA) I2CM_Clock(0, (uint32_t)(now - fallAt));
+    riseAt = now;
+    if (++clocks <= 8) shift = (shift << 1) | sda;
+  } else if (!scl && sclPrev) {
+    if (state == S_DATA) I2CM_Clock(1, (uint32_t)(now - riseAt));
+    fallAt = now;
+    if (clocks == 8) {
+      ack = I2CM_Byte(shift);
+    } else if (clocks == 9) {
+      ack = 0;
+      clocks = 0;
+    }
+  }
+
+  sclPrev = scl;
+  sdaPrev = sda;
+  return ack ? _BV(I2CM_SDA) : 0;
+}
+
+
+/**
+ * @brief   START or repeated START, a transaction in progress is closed for
+ *          its slave but the bus time runs on.
+ * @param   now current cycle
+ * @retval  none
+ */
+static void I2CM_Start(uint64_t now) {
+  stat.starts++;
+  if (state == S_IDLE) startAt = now;
+  if ((state == S_DATA) && cur->stop) cur->stop();
+  state = S_ADDR;
+  cur = NULL;
+  clocks = 0;
+  ack = 0;
+}
+
+
+/**
+ * @brief   STOP, ends the transaction and its bus time.
+ * @param   now current cycle
+ * @retval  none
+ */
+static void I2CM_Stop(uint64_t now) {
+  if (state == S_IDLE) return;
+  stat.stops++;
+  stat.busCycles += now - startAt;
+  if ((state == S_DATA) && cur->stop) cur->stop();
+  state = S_IDLE;
+  cur = NULL;
+  clocks = 0;
+  ack = 0;
+}
+
+
+/**
+ * @brief   A complete byte frame, addresses the slave or hands the data
+ *          byte over. Reads are not modelled and get a NACK.
+ * @param   byte the byte clocked in
+ * @retval  (uint8_t) 1 = ACK, 0 = NACK
+ */
+static uint8_t I2CM_Byte(uint8_t byte) {
+  uint8_t res = 0;
+
+  stat.bytes++;
+  switch (state) {
+    case S_ADDR:
+      state = S_IGNORE;
+      if (byte & 0x01) break;
+      for (uint8_t i = 0; i < devCnt; i++) {
+        if ((dev[i]->addr == (byte >> 1)) && !(gone & _BV(i))) {
+          cur = dev[i];
+          curIdx = i;
+          state = S_DATA;
+          if (cur->start) cur->start();
+          res = 1;
+          break;
+        }
+      }
+      break;
+
+    case S_DATA:
+      res = cur->write(byte);
+      break;
+
+    default:
+      break;
+  }
+
+  if (!res) stat.nacks++;
+  return res;
+}
+
+
+/**
+ * @brief   Keeps the shortest SCL phase of the addressed slave and counts
+ *          the ones under its rated minimum.
+ * @param   high 0 = a low phase ended, 1 = a high phase
+ * @param   len phase length, cycles
+ * @retval  none
+ */
+static void I2CM_Clock(uint8_t high, uint32_t len) {
+  uint32_t* min = high ? &stat.minHigh[curIdx] : &stat.minLow[curIdx];
+  uint32_t lim = high ? limHigh[curIdx] : limLow[curIdx];
+
+  if (!*min || (len < *min)) *min = len;
+  if (len < lim) stat.fast[curIdx]++;
+}
+
+
+/* Getters */
+i2cm_stat_t* I2CM_Stat(void) {
+  return &stat;
+}
+
+
+/**
+ * @brief   Clears the bus activity counters.
+ * @retval  none
+ */
+void I2CM_ResetStat(void) {
+  memset(&stat, 0, sizeof(stat));
+}
+
+
+/**
+ * @brief   Holds SCL low, as a slave stuck in a clock stretch.
+ * @param   cycles hold time from now
+ * @retval  none
+ */
+void I2CM_HoldScl(uint32_t cycles) {
+  sclHold = Host_Cycles() + cycles;
+}
+
+
+/**
+ * @brief   Holds SDA low, as a slave cut off in the middle of a byte. It
+ *          lets go after the given number of SCL clocks.
+ * @param   clocks clocks to let go after, 0 lets go now
+ * @retval  none
+ */
+void I2CM_StickSda(uint8_t clocks) {
+  sdaStuck = clocks;
+}
+
+
+/**
+ * @brief   Plugs a slave model in or out, an unplugged one leaves its
+ *          address unanswered.
+ * @param   addr 7-bit address
+ * @param   on 1 = plugged in
+ * @retval  none
+ */
+void I2CM_SetPresent(uint8_t addr, uint8_t on) {
+  for (uint8_t i = 0; i < devCnt; i++) {
+    if (dev[i]->addr != addr) continue;
+    if (on) {
+      gone &= ~_BV(i);
+    } else {
+      gone |= _BV(i);
+    }
+  }
+}
@@ -0,0 +1,578 @@
+/*
+ * Filename: ow_model.c
+ * Description: The simulated 1-Wire bus on PB4 with N virtual DS18B20
+ *              sensors. Devices follow the line edges made by the firmware:
+ *              reset/presence, ROM search, match/skip/read ROM, conversion,
+ *              scratchpad read/write, copy/recall and power supply query.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 02:14:37 PM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "ow_model.h"
+
+
+#define US(us)          ((uint64_t)(us) * (F_CPU / 1000000UL))
+
+/* --- ROM and function commands --- */
+#define OWM_SEARCH      0xf0
+#define OWM_ALARM       0xec
+#define OWM_READROM     0x33
+#define OWM_MATCHROM    0x55
+#define OWM_SKIPROM     0xcc
+#define OWM_CONVERT     0x44
+#define OWM_WRITEPAD    0x4e
+#define OWM_READPAD     0xbe
+#define OWM_COPYPAD     0x48
+#define OWM_RECALL      0xb8
+#define OWM_POWER       0xb4
+
+/* --- Bus states --- */
+#define S_IDLE          0 // waits for a reset
+#define S_ROMCMD        1
+#define S_SEARCH        2
+#define S_MATCH         3
+#define S_FUNCCMD       4
+#define S_RX            5
+#define S_TX            6
+#define S_BUSY          7
+
+/* --- Transmit sources --- */
+#define TX_PAD          0
+#define TX_ROM          1
+#define TX_POWER        2
+
+
+/* Private variables */
+static owm_cfg_t  cfg;
+static owm_dev_t  dev[OWM_MAX_DEV];
+static uint8_t    devCnt   = 0;
+static owm_stat_t stat;
+static uint8_t    attached = 0;
+
+static uint8_t    state    = S_IDLE;
+static uint8_t    mcuLow   = 0;
+static uint64_t   fallAt   = 0;
+static uint64_t   holdEnd  = 0;
+static uint64_t   presAt   = 0;
+static uint64_t   presEnd  = 0;
+static uint64_t   busyEnd  = 0;
+static uint8_t    shift    = 0;
+static uint8_t    bits     = 0;
+static uint8_t    pos      = 0;   // bit index in ROM match/search and transmit
+static uint8_t    phase    = 0;   // search: bit, complement, direction
+static uint8_t    alarmOnly = 0;
+static uint8_t    txSrc    = TX_PAD;
+static uint8_t    txLen    = 0;
+static uint8_t    rxBuf[3];
+static uint8_t    crcErrors = 0;
+
+/* --- Typical part, the conversion stays under the 750 ms maximum --- */
+static const owm_cfg_t cfgDefault = {480, 30, 30, 30, 120, 700, 10};
+
+/* Private function definitions */
+static void OWM_Attach(void) __attribute__((constructor(HOST_INIT_MODEL)));
+static uint8_t OWM_Bus(uint8_t, uint8_t, uint8_t);
+static uint8_t OWM_Crc(const uint8_t*, uint8_t);
+static void OWM_PadCrc(owm_dev_t*);
+static uint8_t OWM_Alarm(const owm_dev_t*);
+static void OWM_Conversions(uint64_t, uint8_t);
+static void OWM_SlotStart(uint64_t);
+static void OWM_SlotEnd(uint64_t, uint64_t);
+static uint8_t OWM_TxBit(void);
+static void OWM_RxBit(uint8_t, uint64_t);
+static void OWM_RomCommand(uint8_t);
+static void OWM_FuncCommand(uint8_t, uint64_t);
+
+
+
+/**
+ * @brief   Attaches the model to the firmware run when asked for by the
+ *          environment.
+ * @retval  none
+ */
+static void OWM_Attach(void) {
+  const char* env = getenv(OWM_ENV_DEVICES);
+  if (!env) return;
+
+  uint8_t n = (uint8_t)atoi(env);
+  uint8_t parasite = (strchr(env, 'p') != NULL);
+  OWM_Init(NULL);
+  for (uint8_t i = 0; i < n; i++) {
+    uint8_t rom[8];
+    OWM_MakeRom(rom, 0x1000 + i);
+    OWM_AddDevice(rom, 20 * 16 + i * 8, parasite);
+  }
+}
+
+
+/**
+ * @brief   Sets the bus timing up, removes all devices and hooks the bus.
+ * @param   c bus timing, NULL for the datasheet typicals
+ * @retval  none
+ */
+void OWM_Init(const owm_cfg_t* c) {
+  cfg = c ? *c : cfgDefault;
+  OWM_Clear();
+  OWM_ResetStat();
+  if (!attached) {
+    Host_AddBus(OWM_Bus);
+    attached = 1;
+  }
+}
+
+
+/**
+ * @brief   Removes all devices and drops the bus into the idle state.
+ * @retval  none
+ */
+void OWM_Clear(void) {
+  memset(dev, 0, sizeof(dev));
+  devCnt = 0;
+  state = S_IDLE;
+  holdEnd = presAt = presEnd = busyEnd = 0;
+  crcErrors = 0;
+}
+
+
+/**
+ * @brief   Adds a virtual DS18B20.
+ * @param   rom ROM code, CRC included
+ * @param   temp temperature, 1/16 C
+ * @param   parasite 1 = parasite power
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t OWM_AddDevice(const uint8_t* rom, int16_t temp, uint8_t parasite) {
+  if (devCnt >= OWM_MAX_DEV) return 1;
+
+  owm_dev_t* d = &dev[devCnt++];
+  memset(d, 0, sizeof(*d));
+  memcpy(d->rom, rom, sizeof(d->rom));
+  d->temp = temp;
+  d->parasite = parasite;
+  d->ee[0] = 0x4b; // TH 75 C
+  d->ee[1] = 0x46; // TL 70 C
+  d->ee[2] = 0x7f; // 12-bit
+  d->pad[0] = OWM_TEMP_POR & 0xff;
+  d->pad[1] = OWM_TEMP_POR >> 8;
+  memcpy(&d->pad[2], d->ee, sizeof(d->ee));
+  d->pad[5] = 0xff;
+  d->pad[6] = 0x0c;
+  d->pad[7] = 0x10;
+  OWM_PadCrc(d);
+  return 0;
+}
+
+
+/**
+ * @brief   Builds a DS18B20 ROM code with a valid CRC.
+ * @param   rom destination, 8 bytes
+ * @param   serial device serial number
+ * @retval  none
+ */
+void OWM_MakeRom(uint8_t* rom, uint32_t serial) {
+  rom[0] = OWM_FAMILY;
+  for (uint8_t i = 1; i < 7; i++) {
+    rom[i] = (uint8_t)serial;
+    serial >>= 8;
+  }
+  rom[7] = OWM_Crc(rom, 7);
+}
+
+
+/**
+ * @brief   Corrupts the CRC of the next scratchpad reads.
+ * @param   n number of reads to corrupt
+ * @retval  none
+ */
+void OWM_InjectCrcErrors(uint8_t n) {
+  crcErrors = n;
+}
+
+
+/**
+ * @brief   1-Wire CRC8, polynomial x^8 + x^5 + x^4 + 1.
+ * @param   buf data
+ * @param   len data length
+ * @retval  (uint8_t) CRC value
+ */
+static uint8_t OWM_Crc(const uint8_t* buf, uint8_t len) {
+  uint8_t crc = 0;
+  while (len--) {
+    uint8_t b = *buf++;
+    for (uint8_t i = 0; i < 8; i++) {
+      crc = ((crc ^ b) & 0x01) ? ((crc >> 1) ^ 0x8c) : (crc >> 1);
+      b >>= 1;
+    }
+  }
+  return crc;
+}
+
+
+static void OWM_PadCrc(owm_dev_t* d) {
+  d->pad[8] = OWM_Crc(d->pad, 8);
+}
+
+
+/**
+ * @brief   Checks the alarm condition, T >= TH or T <= TL.
+ * @retval  (uint8_t) 1 = alarm
+ */
+static uint8_t OWM_Alarm(const owm_dev_t* d) {
+  int8_t t = (int8_t)((int16_t)(d->pad[0] | (d->pad[1] << 8)) >> 4);
+  return (t >= (int8_t)d->pad[2]) || (t <= (int8_t)d->pad[3]);
+}
+
+
+/**
+ * @brief   Finishes due conversions, a parasite device loses the result when
+ *          the strong pull-up is not held.
+ * @param   now current cycle
+ * @param   strong lines the MCU drives high
+ * @retval  none
+ */
+static void OWM_Conversions(uint64_t now, uint8_t strong) {
+  for (uint8_t i = 0; i < devCnt; i++) {
+    owm_dev_t* d = &dev[i];
+    if (!d->converting) continue;
+
+    uint64_t start = d->convEnd - US((uint32_t)cfg.convMs * 1000);
+    if (d->parasite && (now > start + US(20)) && (now < d->convEnd) && !(strong & _BV(OWM_PIN))) {
+      d->powerLost = 1;
+    }
+    if (now >= d->convEnd) {
+      d->converting = 0;
+      if (!d->powerLost) {
+        d->pad[0] = (uint8_t)d->temp;
+        d->pad[1] = (uint8_t)(d->temp >> 8);
+        OWM_PadCrc(d);
+      }
+    }
+  }
+}
+
+
+/**
+ * @brief   Bus hook, follows the MCU edges on the 1-Wire line and gives the
+ *          device pulls.
+ * @retval  (uint8_t) lines pulled low
+ */
+static uint8_t OWM_Bus(uint8_t drive, uint8_t strong, uint8_t pins) {
+  uint64_t now = Host_Cycles();
+  uint8_t low = drive & _BV(OWM_PIN);
+  (void)pins;
+
+  OWM_Conversions(now, strong);
+
+  if (low && !mcuLow) {
+    mcuLow = 1;
+    fallAt = now;
+    OWM_SlotStart(now);
+  } else if (!low && mcuLow) {
+    mcuLow = 0;
+    OWM_SlotEnd(now - fallAt, now);
+  }
+
+  if ((now >= presAt) && (now < presEnd)) return _BV(OWM_PIN);
+  if (now < holdEnd) return _BV(OWM_PIN);
+  return 0;
+}
+
+
+/**
+ * @brief   A falling edge opens a slot, a transmitting device holds the line
+ *          low for a zero.
+ * @param   now current cycle
+ * @retval  none
+ */
+static void OWM_SlotStart(uint64_t now) {
+  uint8_t tx = 0;
+
+  switch (state) {
+    case S_SEARCH:
+      tx = (phase < 2);
+      break;
+    case S_TX:
+    case S_BUSY:
+      tx = 1;
+      break;
+    default:
+      break;
+  }
+  if (tx && !OWM_TxBit()) holdEnd = now + US(cfg.holdUs);
+}
+
+
+/**
+ * @brief   A rising edge closes the slot or the reset pulse.
+ * @param   len low time, cycles
+ * @param   now current cycle
+ * @retval  none
+ */
+static void OWM_SlotEnd(uint64_t len, uint64_t now) {
+  if (len >= US(cfg.resetUs)) {
+    stat.resets++;
+    for (uint8_t i = 0; i < devCnt; i++) dev[i].active = 0;
+    state = S_ROMCMD;
+    bits = 0;
+    if (devCnt) {
+      presAt = now + US(cfg.presenceDelayUs);
+      presEnd = presAt + US(cfg.presenceUs);
+      stat.presences++;
+    }
+    return;
+  }
+
+  switch (state) {
+    case S_ROMCMD:
+    case S_MATCH:
+    case S_FUNCCMD:
+    case S_RX:
+      stat.writeSlots++;
+      OWM_RxBit(len < US(cfg.sampleUs), now);
+      break;
+
+    case S_SEARCH:
+      if (phase < 2) {
+        stat.readSlots++;
+        phase++;
+      } else {
+        stat.writeSlots++;
+        OWM_RxBit(len < US(cfg.sampleUs), now);
+      }
+      break;
+
+    case S_TX:
+      stat.readSlots++;
+      if (++pos >= txLen) {
+        if ((txSrc == TX_PAD) && crcErrors) crcErrors--;
+        state = S_IDLE;
+      }
+      break;
+
+    case S_BUSY:
+      stat.readSlots++;
+      break;
+
+    default:
+      break;
+  }
+}
+
+
+/**
+ * @brief   Gives the wired-AND of the selected devices for the current slot.
+ * @retval  (uint8_t) bus bit
+ */
+static uint8_t OWM_TxBit(void) {
+  uint8_t bit = 1;
+
+  if (state == S_BUSY) {
+    return Host_Cycles() >= busyEnd;
+  }
+
+  for (uint8_t i = 0; i < devCnt; i++) {
+    owm_dev_t* d = &dev[i];
+    if (!d->active) continue;
+
+    uint8_t b = 1;
+    if (state == S_SEARCH) {
+      b = (d->rom[pos >> 3] >> (pos & 7)) & 0x01;
+      if (phase) b ^= 1;
+    } else if (txSrc == TX_ROM) {
+      b = (d->rom[pos >> 3] >> (pos & 7)) & 0x01;
+    } else if (txSrc == TX_PAD) {
+      b = (d->pad[pos >> 3] >> (pos & 7)) & 0x01;
+      /* --- The injected error flips the CRC byte --- */
+      if (crcErrors && (pos >= 64)) b ^= 1;
+    } else {
+      b = !d->parasite;
+    }
+    bit &= b;
+  }
+  return bit;
+}
+
+
+/**
+ * @brief   Takes a bit written by the master.
+ * @param   bit the bit
+ * @param   now current cycle
+ * @retval  none
+ */
+static void OWM_RxBit(uint8_t bit, uint64_t now) {
+  switch (state) {
+    case S_MATCH:
+    case S_SEARCH:
+      for (uint8_t i = 0; i < devCnt; i++) {
+        if (dev[i].active && (((dev[i].rom[pos >> 3] >> (pos & 7)) & 0x01) != bit)) {
+          dev[i].active = 0;
+        }
+      }
+      phase = 0;
+      if (++pos >= 64) {
+        state = S_FUNCCMD;
+        bits = 0;
+      }
+      return;
+
+    default:
+      break;
+  }
+
+  shift = (shift >> 1) | (bit ? 0x80 : 0);
+  if (++bits & 0x07) return;
+
+  if (state == S_ROMCMD) {
+    OWM_RomCommand(shift);
+  } else if (state == S_FUNCCMD) {
+    OWM_FuncCommand(shift, now);
+  } else if (state == S_RX) {
+    rxBuf[(bits >> 3) - 1] = shift;
+    if (bits >= 24) {
+      for (uint8_t i = 0; i < devCnt; i++) {
+        if (!dev[i].active) continue;
+        memcpy(&dev[i].pad[2], rxBuf, sizeof(rxBuf));
+        OWM_PadCrc(&dev[i]);
+      }
+      state = S_IDLE;
+    }
+  }
+}
+
+
+/**
+ * @brief   Handles a ROM command.
+ * @param   cmd the command
+ * @retval  none
+ */
+static void OWM_RomCommand(uint8_t cmd) {
+  pos = 0;
+  phase = 0;
+  bits = 0;
+
+  switch (cmd) {
+    case OWM_SEARCH:
+    case OWM_ALARM:
+      stat.searches++;
+      alarmOnly = (cmd == OWM_ALARM);
+      for (uint8_t i = 0; i < devCnt; i++) {
+        dev[i].active = !alarmOnly || OWM_Alarm(&dev[i]);
+      }
+      state = S_SEARCH;
+      break;
+
+    case OWM_READROM:
+      for (uint8_t i = 0; i < devCnt; i++) dev[i].active = 1;
+      txSrc = TX_ROM;
+      txLen = 64;
+      state = S_TX;
+      break;
+
+    case OWM_MATCHROM:
+      for (uint8_t i = 0; i < devCnt; i++) dev[i].active = 1;
+      state = S_MATCH;
+      break;
+
+    case OWM_SKIPROM:
+      for (uint8_t i = 0; i < devCnt; i++) dev[i].active = 1;
+      state = S_FUNCCMD;
+      break;
+
+    default:
+      state = S_IDLE;
+      break;
+  }
+}
+
+
+/**
+ * @brief   Handles a function command for the selected devices.
+ * @param   cmd the command
+ * @param   now current cycle
+ * @retval  none
+ */
+static void OWM_FuncCommand(uint8_t cmd, uint64_t now) {
+  pos = 0;
+  bits = 0;
+  busyEnd = now;
+
+  switch (cmd) {
+    case OWM_CONVERT:
+      for (uint8_t i = 0; i < devCnt; i++) {
+        owm_dev_t* d = &dev[i];
+        if (!d->active) continue;
+        d->converting = 1;
+        d->powerLost = 0;
+        d->convEnd = now + US((uint32_t)cfg.convMs * 1000);
+        if (!d->parasite && (d->convEnd > busyEnd)) busyEnd = d->convEnd;
+        stat.conversions++;
+      }
+      state = S_BUSY;
+      break;
+
+    case OWM_READPAD:
+      txSrc = TX_PAD;
+      txLen = 72;
+      state = S_TX;
+      if (crcErrors) stat.crcInjected++;
+      break;
+
+    case OWM_WRITEPAD:
+      state = S_RX;
+      break;
+
+    case OWM_COPYPAD:
+      for (uint8_t i = 0; i < devCnt; i++) {
+        if (dev[i].active) memcpy(dev[i].ee, &dev[i].pad[2], sizeof(dev[i].ee));
+      }
+      busyEnd = now + US((uint32_t)cfg.copyMs * 1000);
+      state = S_BUSY;
+      break;
+
+    case OWM_RECALL:
+      for (uint8_t i = 0; i < devCnt; i++) {
+        if (!dev[i].active) continue;
+        memcpy(&dev[i].pad[2], dev[i].ee, sizeof(dev[i].ee));
+        OWM_PadCrc(&dev[i]);
+      }
+      state = S_BUSY;
+      break;
+
+    case OWM_POWER:
+      txSrc = TX_POWER;
+      txLen = 1;
+      state = S_TX;
+      break;
+
+    default:
+      state = S_IDLE;
+      break;
+  }
+}
+
+
+/* Getters */
+owm_dev_t* OWM_Device(uint8_t i) {
+  return (i < devCnt) ? &dev[i] : NULL;
+}
+
+uint8_t OWM_DeviceCount(void) {
+  return devCnt;
+}
+
+owm_cfg_t* OWM_Config(void) {
+  return &cfg;
+}
+
+owm_stat_t* OWM_Stat(void) {
+  return &stat;
+}
+
+void OWM_ResetStat(void) {
+  memset(&stat, 0, sizeof(stat));
+}
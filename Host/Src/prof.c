@@ -0,0 +1,390 @@
+/*
+ * Filename: prof.c
+ * Description: The sampling cycle profiler for the host-native build. The
+ *              firmware is built with -finstrument-functions, the entry and
+ *              exit hooks keep a shadow call stack, and the HAL clock takes
+ *              a sample of it every fixed number of emulated cycles. Samples
+ *              are mapped to symbols from the executable's own ELF table.
+ *              The hooks also clock the host time spent in each function,
+ *              so compute the emulated clock does not charge shows up too.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 11:20:54 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include <avr/io.h>
+#include <elf.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* --- Environment, the profile is taken when SML_PROF names the output --- */
+/* --- <prefix>.txt flat profile, <prefix>.folded collapsed stacks --- */
+#define PROF_ENV_OUT      "SML_PROF"
+#define PROF_ENV_CYCLES   "SML_PROF_CYCLES" // sample period, emulated cycles
+#define PROF_CYCLES       160               // 10 us at 16 MHz
+
+#define PROF_DEPTH        32    // frames kept per stack
+#define PROF_STACKS       4096  // distinct stacks kept, a power of two
+#define PROF_FUNCS        1024  // functions clocked on the host, a power of two
+#define PROF_PATH_MAX     256
+#define PROF_TOP          10    // functions shown in the run report
+
+
+/* A distinct call stack and its samples */
+typedef struct {
+  uint64_t  samples;
+  uint32_t  hash;
+  uint8_t   depth;
+  void*     fn[PROF_DEPTH];
+} prof_stack_t;
+
+
+/* Host time of a function */
+typedef struct {
+  void*     fn;
+  uint64_t  ns;
+} prof_host_t;
+
+
+/* A function symbol and its flat profile */
+typedef struct {
+  uintptr_t   addr;
+  uint64_t    size;
+  const char* name;
+  uint64_t    self;
+  uint64_t    total;
+  uint64_t    host;   // host ns in the function itself
+} prof_sym_t;
+
+
+/* Private variables */
+static void*          shadow[PROF_DEPTH];
+static uint16_t       depth    = 0;
+static prof_stack_t*  stacks   = NULL;
+static uint64_t       dropped  = 0;
+static uint64_t       samples  = 0;
+static uint32_t       every    = PROF_CYCLES;
+static const char*    prefix   = NULL;
+static prof_host_t*   hosts    = NULL;
+static uint64_t       hostLast = 0;
+static uint64_t       hostAll  = 0;
+
+static prof_sym_t*    syms     = NULL;
+static uint32_t       symCnt   = 0;
+static uintptr_t      bias     = 0;
+
+/* Private function definitions */
+static void Prof_Attach(void) __attribute__((constructor(HOST_INIT_MODEL)));
+static void Prof_Sample(uint32_t);
+static uint8_t Prof_Report(FILE*);
+static void Prof_LoadSymbols(void);
+static int Prof_SymCmp(const void*, const void*);
+static int Prof_SelfCmp(const void*, const void*);
+static int Prof_HostCmp(const void*, const void*);
+static prof_sym_t* Prof_Lookup(void*);
+static const char* Prof_Name(void*, char*);
+static void Prof_Clock(void*) __attribute__((no_instrument_function));
+
+void __cyg_profile_func_enter(void*, void*) __attribute__((no_instrument_function));
+void __cyg_profile_func_exit(void*, void*) __attribute__((no_instrument_function));
+
+
+
+/**
+ * @brief   Starts sampling when asked for by the environment.
+ * @retval  none
+ */
+static void Prof_Attach(void) {
+  prefix = getenv(PROF_ENV_OUT);
+  if (!prefix) return;
+
+  const char* c = getenv(PROF_ENV_CYCLES);
+  if (c && atoi(c) > 0) every = (uint32_t)atoi(c);
+  stacks = calloc(PROF_STACKS, sizeof(prof_stack_t));
+  if (!stacks) return;
+  hosts = calloc(PROF_FUNCS, sizeof(prof_host_t));
+
+  Host_SetSampler(Prof_Sample, every);
+  Host_AddReport(Prof_Report);
+}
+
+
+/**
+ * @brief   Function entry hook, pushes the shadow stack.
+ * @param   fn function entered
+ * @param   site call site
+ * @retval  none
+ */
+void __cyg_profile_func_enter(void* fn, void* site) {
+  (void)site;
+  if (depth && (depth <= PROF_DEPTH)) Prof_Clock(shadow[depth - 1]);
+  if (depth < PROF_DEPTH) shadow[depth] = fn;
+  depth++;
+}
+
+
+/**
+ * @brief   Function exit hook, pops the shadow stack.
+ * @retval  none
+ */
+void __cyg_profile_func_exit(void* fn, void* site) {
+  (void)site;
+  Prof_Clock(fn);
+  if (depth) depth--;
+}
+
+
+/**
+ * @brief   Charges the host time since the last hook to a function. It
+ *          takes in the HAL calls the function makes.
+ * @param   fn function on the top of the stack
+ * @retval  none
+ */
+static void Prof_Clock(void* fn) {
+  struct timespec ts;
+
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  uint64_t now = (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+  uint64_t ns = hostLast ? now - hostLast : 0;
+  hostLast = now;
+  if (!hosts) return;
+
+  hostAll += ns;
+  for (uint32_t i = 0; i < PROF_FUNCS; i++) {
+    prof_host_t* h = &hosts[((uintptr_t)fn / 16 + i) & (PROF_FUNCS - 1)];
+    if (!h->fn) h->fn = fn;
+    if (h->fn == fn) {
+      h->ns += ns;
+      return;
+    }
+  }
+}
+
+
+/**
+ * @brief   Clock sampler, charges the current stack.
+ * @param   n sample periods passed since the last call
+ * @retval  none
+ */
+static void Prof_Sample(uint32_t n) {
+  uint8_t d = (depth < PROF_DEPTH) ? (uint8_t)depth : PROF_DEPTH;
+  uint32_t h = 2166136261u;
+
+  for (uint8_t i = 0; i < d; i++) {
+    h = (h ^ (uint32_t)((uintptr_t)shadow[i] >> 2)) * 16777619u;
+  }
+  h ^= d;
+  samples += n;
+
+  /* --- Open addressing, a stack is found by its hash and frames --- */
+  for (uint32_t i = 0; i < PROF_STACKS; i++) {
+    prof_stack_t* s = &stacks[(h + i) & (PROF_STACKS - 1)];
+    if (!s->samples) {
+      s->hash = h;
+      s->depth = d;
+      memcpy(s->fn, shadow, d * sizeof(void*));
+      s->samples = n;
+      return;
+    }
+    if ((s->hash == h) && (s->depth == d) && !memcmp(s->fn, shadow, d * sizeof(void*))) {
+      s->samples += n;
+      return;
+    }
+  }
+  dropped += n;
+}
+
+
+/**
+ * @brief   Writes the flat profile and the collapsed stacks, and shows the
+ *          top functions by cycles and by host time in the run report.
+ * @param   out report stream
+ * @retval  (uint8_t) 0, the report does not judge the run
+ */
+static uint8_t Prof_Report(FILE* out) {
+  char path[PROF_PATH_MAX];
+  char name[32];
+
+  Prof_LoadSymbols();
+  for (uint32_t i = 0; hosts && (i < PROF_FUNCS); i++) {
+    prof_sym_t* sym = hosts[i].fn ? Prof_Lookup(hosts[i].fn) : NULL;
+    if (sym) sym->host += hosts[i].ns;
+  }
+
+  /* --- Collapsed stacks, one line per stack, flamegraph.pl input --- */
+  snprintf(path, sizeof(path), "%s.folded", prefix);
+  FILE* f = fopen(path, "w");
+  for (uint32_t i = 0; i < PROF_STACKS; i++) {
+    prof_stack_t* s = &stacks[i];
+    if (!s->samples) continue;
+
+    if (f) {
+      if (!s->depth) fputs("(none)", f);
+      for (uint8_t j = 0; j < s->depth; j++) {
+        fprintf(f, "%s%s", j ? ";" : "", Prof_Name(s->fn[j], name));
+      }
+      fprintf(f, " %llu\n", (unsigned long long)s->samples);
+    }
+
+    /* --- Self on the top frame, total once per function in the stack --- */
+    for (uint8_t j = 0; j < s->depth; j++) {
+      prof_sym_t* sym = Prof_Lookup(s->fn[j]);
+      if (!sym) continue;
+      uint8_t seen = 0;
+      for (uint8_t k = 0; k < j; k++) seen |= (Prof_Lookup(s->fn[k]) == sym);
+      if (!seen) sym->total += s->samples;
+      if (j == s->depth - 1) sym->self += s->samples;
+    }
+  }
+  if (f) fclose(f);
+
+  /* --- Flat profile, by self time --- */
+  qsort(syms, symCnt, sizeof(prof_sym_t), Prof_SelfCmp);
+  snprintf(path, sizeof(path), "%s.txt", prefix);
+  f = fopen(path, "w");
+  double all = samples ? (double)samples : 1.0;
+  double allNs = hostAll ? (double)hostAll : 1.0;
+  if (f) {
+    fprintf(f, "# %llu samples every %u cycles, %llu dropped\n",
+            (unsigned long long)samples, every, (unsigned long long)dropped);
+    fprintf(f, "# cycles: emulated bus, delay and sleep time only, compute costs none\n");
+    fprintf(f, "# host: x86 time in the function and its HAL calls, not AVR cycles\n");
+    fprintf(f, "# %7s %14s %7s %14s %7s %12s  %s\n", "self%", "self.cyc", "total%", "total.cyc",
+            "host%", "host.us", "function");
+  }
+  fprintf(out, "prof: %llu samples every %u cycles, %llu dropped\n",
+          (unsigned long long)samples, every, (unsigned long long)dropped);
+  fprintf(out, "prof: cycles cover bus, delay and sleep time only\n");
+  for (uint32_t i = 0; i < symCnt; i++) {
+    prof_sym_t* sym = &syms[i];
+    if (!sym->total && !sym->host) continue;
+    if (f) {
+      fprintf(f, "  %7.2f %14llu %7.2f %14llu %7.2f %12llu  %s\n", sym->self * 100.0 / all,
+              (unsigned long long)sym->self * every, sym->total * 100.0 / all,
+              (unsigned long long)sym->total * every, sym->host * 100.0 / allNs,
+              (unsigned long long)sym->host / 1000, sym->name);
+    }
+    if (i < PROF_TOP) {
+      fprintf(out, "prof: %6.2f%% self %6.2f%% total  %s\n",
+              sym->self * 100.0 / all, sym->total * 100.0 / all, sym->name);
+    }
+  }
+  if (f) fclose(f);
+
+  /* --- Host time shows the compute the emulated clock leaves out --- */
+  qsort(syms, symCnt, sizeof(prof_sym_t), Prof_HostCmp);
+  for (uint32_t i = 0; (i < symCnt) && (i < PROF_TOP) && syms[i].host; i++) {
+    fprintf(out, "prof: %6.2f%% host  %s\n", syms[i].host * 100.0 / allNs, syms[i].name);
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Reads the function symbols of the running executable. The load
+ *          bias of a PIE build comes from a function of known address.
+ * @retval  none
+ */
+static void Prof_LoadSymbols(void) {
+  FILE* f = fopen("/proc/self/exe", "rb");
+  if (!f) return;
+  fseek(f, 0, SEEK_END);
+  long len = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t* img = malloc(len);
+  if (!img || (fread(img, 1, len, f) != (size_t)len)) {
+    fclose(f);
+    free(img);
+    return;
+  }
+  fclose(f);
+
+  Elf64_Ehdr* eh = (Elf64_Ehdr*)img;
+  Elf64_Shdr* sh = (Elf64_Shdr*)(img + eh->e_shoff);
+  for (uint16_t i = 0; i < eh->e_shnum; i++) {
+    if (sh[i].sh_type != SHT_SYMTAB) continue;
+
+    Elf64_Sym* sym = (Elf64_Sym*)(img + sh[i].sh_offset);
+    const char* str = (const char*)(img + sh[sh[i].sh_link].sh_offset);
+    uint32_t n = sh[i].sh_size / sizeof(Elf64_Sym);
+    syms = calloc(n, sizeof(prof_sym_t));
+    if (!syms) return;
+
+    for (uint32_t j = 0; j < n; j++) {
+      if ((ELF64_ST_TYPE(sym[j].st_info) != STT_FUNC) || !sym[j].st_value) continue;
+      prof_sym_t* s = &syms[symCnt++];
+      s->addr = sym[j].st_value;
+      s->size = sym[j].st_size;
+      s->name = strdup(str + sym[j].st_name);
+      if (!strcmp(s->name, "Prof_Report")) bias = (uintptr_t)Prof_Report - s->addr;
+    }
+  }
+  /* --- The image goes, the names stay --- */
+  free(img);
+
+  for (uint32_t i = 0; i < symCnt; i++) syms[i].addr += bias;
+  qsort(syms, symCnt, sizeof(prof_sym_t), Prof_SymCmp);
+}
+
+
+static int Prof_SymCmp(const void* a, const void* b) {
+  uintptr_t x = ((const prof_sym_t*)a)->addr;
+  uintptr_t y = ((const prof_sym_t*)b)->addr;
+  return (x > y) - (x < y);
+}
+
+
+static int Prof_SelfCmp(const void* a, const void* b) {
+  const prof_sym_t* x = (const prof_sym_t*)a;
+  const prof_sym_t* y = (const prof_sym_t*)b;
+  if (x->self != y->self) return (x->self < y->self) - (x->self > y->self);
+  return (x->total < y->total) - (x->total > y->total);
+}
+
+
+static int Prof_HostCmp(const void* a, const void* b) {
+  uint64_t x = ((const prof_sym_t*)a)->host;
+  uint64_t y = ((const prof_sym_t*)b)->host;
+  return (x < y) - (x > y);
+}
+
+
+/**
+ * @brief   Finds the symbol of a function entry address.
+ * @param   fn function address
+ * @retval  (prof_sym_t*) the symbol, NULL if unknown
+ */
+static prof_sym_t* Prof_Lookup(void* fn) {
+  uintptr_t a = (uintptr_t)fn;
+  uint32_t lo = 0, hi = symCnt;
+
+  while (lo < hi) {
+    uint32_t mid = (lo + hi) / 2;
+    if (syms[mid].addr <= a) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  if (!lo) return NULL;
+  prof_sym_t* s = &syms[lo - 1];
+  return ((s->addr == a) || (a < s->addr + s->size)) ? s : NULL;
+}
+
+
+/**
+ * @brief   Gives a printable function name.
+ * @param   fn function address
+ * @param   buf room for a hex address
+ * @retval  (const char*) the name
+ */
+static const char* Prof_Name(void* fn, char* buf) {
+  prof_sym_t* s = Prof_Lookup(fn);
+  if (s) return s->name;
+  snprintf(buf, 32, "%p", fn);
+  return buf;
+}
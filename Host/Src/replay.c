@@ -0,0 +1,380 @@
+/*
+ * Filename: replay.c
+ * Description: The pin trace replay for the host-native build. Loads a field
+ *              EEPROM image with a frozen capture, runs the firmware with the
+ *              device models of the image ROM table and, on the captured
+ *              transaction, drives the bus lines the way the field devices
+ *              did. Reports the bus time of the replayed window.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 02:41:09 PM
+ * Author: Dmitry Slobodchikov
+ */
+
+/* --- Unity build, the firmware runs under the replay hooks --- */
+#define main Firmware_Main
+#include "../../main.c"
+#undef main
+#include "ow_model.h"
+#include "dspl_model.h"
+
+#include <string.h>
+
+
+#define REPLAY_ENV_IMAGE  "SML_REPLAY"      // EEPROM image holding the capture
+#define REPLAY_RESET_US   400               // MCU low pulse taken as a 1-Wire reset
+#define REPLAY_AFTER_MS   2000              // run on after the window, ms
+#define REPLAY_MAX_MS     3600000           // gives up on a window that does not come
+#define REPLAY_TEMP       (21 * 16)         // model temperature outside the window
+#define REPLAY_OW_MAX     15                // ROM table entries, the _OWREG_ counter width
+
+#define REPLAY_CYC_PER_US (F_CPU / 1000000UL)
+#define REPLAY_CYC_PER_CNT (PTRACE_US_PER_CNT * REPLAY_CYC_PER_US)
+
+/* --- Replay states --- */
+#define R_WAIT            0 // counts the bus transactions up to the captured one
+#define R_PLAY            1
+#define R_DONE            2
+
+
+/* Private constants */
+static const uint8_t busPins[PTRACE_BUSES] = {
+  _BV(OW0PIN),
+  _BV(I2CSDA)|_BV(I2CSCL),
+  _BV(DSPLDIO)|_BV(DSPLCLK)
+};
+static const char* busName[PTRACE_BUSES] = {"1-Wire", "I2C", "TM1637"};
+static const char* siteName[] = {"none", "no presence", "ROM search", "ROM CRC",
+                                 "scratchpad CRC", "I2C NACK", "TM1637 NACK"};
+
+/* Private variables */
+static ptrace_hdr_t hdr;
+static uint8_t      entry[PTRACE_SIZE];
+static uint8_t      lines    = 0;   // lines of the captured bus
+static uint8_t      state    = R_WAIT;
+static uint16_t     arms     = 0;
+static uint8_t      k        = 0;   // next entry
+static uint8_t      mcuPrev  = 0;   // lines the MCU pulled low
+static uint8_t      held     = 0;   // lines a device holds low
+static uint8_t      down     = 0;   // lines low since their last rise
+static uint64_t     ref      = 0;   // the previous edge on the traced lines
+static uint64_t     fallAt[8];
+static uint64_t     relAt[8];
+static uint64_t     heldAt[8];
+
+/* --- Window statistics, cycles --- */
+static uint64_t     startAt  = 0;
+static uint64_t     endAt    = 0;
+static uint64_t     mcuLow   = 0;
+static uint64_t     devLow   = 0;
+static uint32_t     holds    = 0;
+static uint64_t     holdSum  = 0;
+static uint64_t     holdMin  = UINT64_MAX;
+static uint64_t     holdMax  = 0;
+static uint32_t     pulls    = 0;
+static uint64_t     pullDelay = 0;  // first device pull after the previous edge
+static uint64_t     pullLen  = 0;
+
+/* Private function definitions */
+static uint8_t Replay_Load(const char*);
+static uint8_t Replay_Bus(uint8_t, uint8_t, uint8_t);
+static uint8_t Replay_Armed(uint8_t, uint8_t, uint8_t, uint64_t);
+static void Replay_Step(uint64_t, uint8_t, uint8_t);
+static uint64_t Replay_Rise(uint8_t, uint64_t);
+static uint8_t Replay_Pull(uint64_t, uint8_t);
+static uint8_t Replay_Line(uint8_t);
+static uint8_t Replay_Report(FILE*);
+static double Replay_Us(uint64_t);
+
+
+
+/**
+ * @brief   Loads the capture, puts the image devices on the bus and runs the
+ *          firmware. The run ends REPLAY_AFTER_MS after the window, or on
+ *          SML_HOST_MS when given.
+ * @retval  (int) process exit code
+ */
+int main(void) {
+  const char* image = getenv(REPLAY_ENV_IMAGE);
+
+  if (!image || Replay_Load(image)) {
+    fprintf(stderr, "replay: %s=<EEPROM image with a pin trace> is needed\n", REPLAY_ENV_IMAGE);
+    return 1;
+  }
+  if (!getenv(HOST_ENV_MS)) Host_SetRunLimit(REPLAY_MAX_MS);
+  DSPM_Init(getenv(DSPM_ENV_CAPTURE));
+  Host_AddBus(Replay_Bus);
+  Host_AddReport(Replay_Report);
+
+  fprintf(stderr, "replay: %s transaction %u, %s, %u entries, %u lost, %u devices\n",
+          busName[hdr.bus], hdr.arms, siteName[hdr.site], hdr.count, hdr.lost, OWM_DeviceCount());
+  return Firmware_Main();
+}
+
+
+/**
+ * @brief   Reads the capture and the ROM table out of the EEPROM image.
+ * @param   path image file
+ * @retval  (uint8_t) status of operation
+ */
+static uint8_t Replay_Load(const char* path) {
+  uint8_t ee[E2END + 1];
+  FILE* f = fopen(path, "rb");
+
+  if (!f) return 1;
+  size_t n = fread(ee, 1, sizeof(ee), f);
+  fclose(f);
+  if (n != sizeof(ee)) return 1;
+
+  memcpy(&hdr, &ee[EE_PTRACE_ADDR], sizeof(hdr));
+  if ((hdr.magic != PTRACE_MAGIC) || (hdr.bus >= PTRACE_BUSES) || (hdr.count > PTRACE_SIZE)) return 1;
+  if (hdr.site >= sizeof(siteName) / sizeof(siteName[0])) hdr.site = PTRACE_SITE_NONE;
+  memcpy(entry, &ee[EE_PTRACE_ADDR + sizeof(hdr)], hdr.count);
+  lines = busPins[hdr.bus];
+
+  /* --- The field devices answer outside the window, the same ROMs keep --- */
+  /* --- the transactions in the same order --- */
+  OWM_Init(NULL);
+  for (uint8_t i = 0; i < REPLAY_OW_MAX; i++) {
+    const uint8_t* rom = &ee[EE_OW_ADDR + i * 8];
+    uint8_t crc = 0;
+    for (uint8_t j = 0; j < 8; j++) crc = OneWire_CRC(crc, rom[j]);
+    if (crc || !rom[0] || (rom[0] == 0xff)) break;
+    OWM_AddDevice(rom, REPLAY_TEMP, 0);
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Bus hook, counts the transactions of the captured bus and drives
+ *          its lines from the capture while the window runs.
+ * @retval  (uint8_t) lines pulled low
+ */
+static uint8_t Replay_Bus(uint8_t drive, uint8_t strong, uint8_t pins) {
+  uint64_t now = Host_Cycles();
+  uint8_t low = drive & lines;
+  uint8_t fell = low & ~mcuPrev;
+  uint8_t rose = mcuPrev & ~low;
+  uint8_t pull = 0;
+  (void)strong;
+  (void)pins;
+
+  for (uint8_t i = 0; i < 8; i++) {
+    if (rose & _BV(i)) {
+      relAt[i] = now;
+      if (state == R_PLAY) mcuLow += now - fallAt[i];
+    }
+  }
+  mcuPrev = low;
+
+  if ((state == R_WAIT) && Replay_Armed(drive, fell, rose, now) && (++arms == hdr.arms)) {
+    state = R_PLAY;
+    startAt = ref;
+    held = 0;
+    /* --- A reset pulse ends on arming, its release is the first entry --- */
+    down = low | rose;
+    for (uint8_t i = 0; i < 8; i++) {
+      if (rose & _BV(i)) mcuLow += now - fallAt[i];
+    }
+    Host_Override(Replay_Bus, lines);
+  }
+  if (state == R_PLAY) {
+    Replay_Step(now, low, fell);
+    pull = Replay_Pull(now, low);
+  }
+
+  /* --- Taken after the step, a flushed rise still sees the previous pull --- */
+  for (uint8_t i = 0; i < 8; i++) {
+    if (fell & _BV(i)) fallAt[i] = now;
+  }
+  return pull;
+}
+
+
+/**
+ * @brief   Finds the start of a transaction on the captured bus, the point
+ *          the firmware armed the trace at: a 1-Wire reset pulse or a START.
+ *          The time reference is its first MCU edge.
+ * @retval  (uint8_t) 1 = a transaction starts
+ */
+static uint8_t Replay_Armed(uint8_t drive, uint8_t fell, uint8_t rose, uint64_t now) {
+  switch (hdr.bus) {
+    case PTRACE_OW:
+      if ((rose & _BV(OW0PIN)) && (now - fallAt[OW0PIN] >= REPLAY_RESET_US * REPLAY_CYC_PER_US)) {
+        ref = fallAt[OW0PIN];
+        return 1;
+      }
+      return 0;
+
+    case PTRACE_I2C:
+      ref = now;
+      return (fell & _BV(I2CSDA)) && !(drive & _BV(I2CSCL));
+
+    default:
+      ref = now;
+      return (fell & _BV(DSPLDIO)) && !(drive & _BV(DSPLCLK));
+  }
+}
+
+
+/**
+ * @brief   Plays the entries that are due. A device pull starts its time
+ *          after the previous edge, a rise waits for the line to be down
+ *          and for the MCU to let go too.
+ * @param   now current cycle
+ * @param   low lines the MCU pulls low
+ * @param   fell lines the MCU has just pulled low
+ * @retval  none
+ */
+static void Replay_Step(uint64_t now, uint8_t low, uint8_t fell) {
+  /* --- A new MCU pull on a line still down means the device let go before it --- */
+  while ((k < hdr.count) && !PTRACE_FALL(entry[k]) && (fell & down & _BV(Replay_Line(entry[k])))) {
+    uint8_t b = Replay_Line(entry[k]);
+    uint64_t at = ref + (uint64_t)PTRACE_DT(entry[k]) * REPLAY_CYC_PER_CNT;
+    if (at < relAt[b]) at = relAt[b];
+    ref = Replay_Rise(b, (at < now) ? at : now);
+    k++;
+  }
+  if (fell & ~held) ref = now;
+  down |= fell;
+
+  while (k < hdr.count) {
+    uint8_t e = entry[k];
+    uint8_t b = Replay_Line(e);
+    uint64_t due = ref + (uint64_t)PTRACE_DT(e) * REPLAY_CYC_PER_CNT;
+
+    if (PTRACE_FALL(e)) {
+      if (now < due) break;
+      if (!(held & _BV(b))) {
+        held |= _BV(b);
+        down |= _BV(b);
+        heldAt[b] = due;
+        if (!pulls++) pullDelay = due - ref;
+      }
+    } else {
+      if ((low & _BV(b)) || !(down & _BV(b))) break;
+      uint64_t at = (due > relAt[b]) ? due : relAt[b];
+      if (now < at) break;
+      due = Replay_Rise(b, at);
+    }
+    ref = due;
+    k++;
+  }
+
+  if (k >= hdr.count) {
+    state = R_DONE;
+    endAt = now;
+    Host_Override(NULL, 0);
+    if (!getenv(HOST_ENV_MS)) Host_SetRunLimit((uint32_t)(now / (F_CPU / 1000)) + REPLAY_AFTER_MS);
+  }
+}
+
+
+/**
+ * @brief   Lets a line rise and adds its low time to the statistics.
+ * @param   b PORTB bit
+ * @param   at cycle of the rise
+ * @retval  (uint64_t) cycle of the rise
+ */
+static uint64_t Replay_Rise(uint8_t b, uint64_t at) {
+  /* --- Held past the MCU release: a device stretched the line --- */
+  if (!(held & _BV(b)) && (at > relAt[b]) && (relAt[b] > fallAt[b])) {
+    uint64_t h = at - relAt[b];
+    devLow += h;
+    holdSum += h;
+    holds++;
+    if (h < holdMin) holdMin = h;
+    if (h > holdMax) holdMax = h;
+  } else if (held & _BV(b)) {
+    devLow += at - heldAt[b];
+    if (pulls == 1 && !pullLen) pullLen = at - heldAt[b];
+  }
+  held &= ~_BV(b);
+  down &= ~_BV(b);
+  return at;
+}
+
+
+/**
+ * @brief   Lines the devices hold low now: pulled ones and the ones whose
+ *          captured rise is still ahead.
+ * @param   now current cycle
+ * @param   low lines the MCU pulls low
+ * @retval  (uint8_t) lines pulled low
+ */
+static uint8_t Replay_Pull(uint64_t now, uint8_t low) {
+  uint8_t pull = held;
+
+  if ((state == R_PLAY) && !PTRACE_FALL(entry[k])) {
+    uint8_t b = Replay_Line(entry[k]);
+    uint64_t due = ref + (uint64_t)PTRACE_DT(entry[k]) * REPLAY_CYC_PER_CNT;
+    if (!(low & _BV(b)) && (now < due)) pull |= _BV(b);
+  }
+  return pull;
+}
+
+
+/**
+ * @brief   Gives the line of an entry.
+ * @param   e entry
+ * @retval  (uint8_t) PORTB bit
+ */
+static uint8_t Replay_Line(uint8_t e) {
+  uint8_t idx = PTRACE_PIN(e);
+
+  for (uint8_t bit = PB0; bit <= PB4; bit++) {
+    if (!(PTRACE_PINS & _BV(bit))) continue;
+    if (!idx--) return bit;
+  }
+  return PB0;
+}
+
+
+/**
+ * @brief   End of run report: the window and its bus time.
+ * @param   out report stream
+ * @retval  (uint8_t) 1 if the window did not run through
+ */
+static uint8_t Replay_Report(FILE* out) {
+  if (state == R_WAIT) {
+    fprintf(out, "replay: %u of %u %s transactions seen, the window never started\n",
+            arms, hdr.arms, busName[hdr.bus]);
+    return 1;
+  }
+  if (state == R_PLAY) endAt = Host_Cycles();
+
+  uint64_t len = endAt - startAt;
+  fprintf(out, "replay: window at %.3f ms, %.0f us, %u of %u entries%s\n",
+          startAt / (double)(F_CPU / 1000), Replay_Us(len), k, hdr.count,
+          hdr.lost ? ", the field window was longer than the ring" : "");
+  fprintf(out, "replay: MCU low %.0f us, device low %.0f us, bus low %.1f%% of the window\n",
+          Replay_Us(mcuLow), Replay_Us(devLow), len ? (mcuLow + devLow) * 100.0 / len : 0.0);
+  if (holds) {
+    fprintf(out, "replay: %u device holds past the MCU release, min %.0f avg %.1f max %.0f us\n",
+            holds, Replay_Us(holdMin), Replay_Us(holdSum) / holds, Replay_Us(holdMax));
+  }
+  if (pulls) {
+    fprintf(out, "replay: %u device pulls, the first %.0f us after the previous edge, %.0f us long\n",
+            pulls, Replay_Us(pullDelay), Replay_Us(pullLen));
+  }
+#if defined(PIN_TRACE)
+  const ptrace_hdr_t* h = PinTrace_Header();
+  uint8_t same = (h->site == hdr.site) && (h->bus == hdr.bus) && (h->arms == hdr.arms);
+  fprintf(out, "replay: firmware froze at %s transaction %u, %s: %s\n", busName[h->bus], h->arms,
+          (h->site < sizeof(siteName) / sizeof(siteName[0])) ? siteName[h->site] : "?",
+          same ? "reproduced" : "differs from the field");
+#endif
+  return (state != R_DONE);
+}
+
+
+/**
+ * @brief   Cycles in microseconds.
+ * @param   c cycles
+ * @retval  (double) microseconds
+ */
+static double Replay_Us(uint64_t c) {
+  return (double)c / REPLAY_CYC_PER_US;
+}
@@ -0,0 +1,269 @@
+/*
+ * Filename: soak.c
+ * Description: The accelerated-time soak runner for the host-native build.
+ *              Starts the firmware with the tick and second counters close
+ *              to their wrap, runs it on the HAL clock as fast as the host
+ *              allows and checks task cadence, display output and sensor
+ *              readings all the way.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 09:48:21 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+/* --- Unity build, the counters in main.c are preset directly --- */
+#define main Firmware_Main
+#include "../../main.c"
+#undef main
+#include "ow_model.h"
+#include "dspl_model.h"
+
+#include <string.h>
+#include <time.h>
+
+
+#define SOAK_ENV_WRAP     "SML_SOAK_WRAP"   // seconds before the counters wrap, 0 = start at zero
+#define SOAK_WRAP_S       30
+#define SOAK_JITTER_MS    30                // a tick plus the longest blocking task run
+#define SOAK_PROGRESS_S   3600              // simulated seconds between progress lines
+#define SOAK_FAIL_SHOWN   10                // failures printed in full
+#define SOAK_SENSORS      2
+
+#define SOAK_LED          PB1
+
+
+/* A cadence or content check */
+typedef struct {
+  const char* name;
+  uint32_t    count;
+  uint32_t    fails;
+  int32_t     min;
+  int32_t     max;
+} soak_chk_t;
+
+
+/* Private variables */
+static soak_chk_t chkLed    = {"led period ms",     0, 0, INT32_MAX, INT32_MIN};
+static soak_chk_t chkPrint  = {"print period ms",   0, 0, INT32_MAX, INT32_MIN};
+static soak_chk_t chkSec    = {"sec: drift s",      0, 0, INT32_MAX, INT32_MIN};
+static soak_chk_t chkLcd    = {"lcd line 1",        0, 0, INT32_MAX, INT32_MIN};
+static soak_chk_t chkTemp   = {"T: reading",        0, 0, INT32_MAX, INT32_MIN};
+static soak_chk_t chkSensor = {"conversion gap ms", 0, 0, INT32_MAX, INT32_MIN};
+
+static uint32_t   secStart  = 0;
+static uint8_t    ledLevel  = 0xff;
+static uint64_t   ledAt     = 0;
+static uint64_t   prnAt     = 0;
+static uint32_t   convCnt   = 0;
+static uint64_t   convAt    = 0;
+static uint64_t   progressAt = 0;
+static uint32_t   failShown = 0;
+static struct timespec wallStart;
+
+/* Private function definitions */
+static uint8_t Soak_Bus(uint8_t, uint8_t, uint8_t);
+static void Soak_Stream(const char*, size_t, uint8_t);
+static uint8_t Soak_Report(FILE*);
+static void Soak_Check(soak_chk_t*, int32_t, uint8_t, const char*);
+static uint64_t Soak_Ms(uint64_t);
+static double Soak_Wall(void);
+
+
+
+/**
+ * @brief   Presets the counters, hooks the checks and runs the firmware.
+ *          The run ends on SML_HOST_MS, the exit code tells the result.
+ * @retval  (int) process exit code
+ */
+int main(void) {
+  const char* env = getenv(SOAK_ENV_WRAP);
+  uint32_t wrap = env ? (uint32_t)strtoul(env, NULL, 10) : SOAK_WRAP_S;
+
+  /* --- A coherent state of a long uptime, both counters wrap together --- */
+  if (wrap) {
+    sysCnt = (uint32_t)0 - wrap * SEC_TICKS;
+    secMark = sysCnt + SEC_TICKS;
+    secCnt = (uint32_t)0 - wrap;
+  }
+  secStart = secCnt;
+
+  OWM_Init(NULL);
+  for (uint8_t i = 0; i < SOAK_SENSORS; i++) {
+    uint8_t rom[8];
+    OWM_MakeRom(rom, 0x5000 + i);
+    OWM_AddDevice(rom, 21 * 16 + i * 4, 0);
+  }
+  DSPM_Init(getenv(DSPM_ENV_CAPTURE));
+
+  Host_AddBus(Soak_Bus);
+  Host_AddStream(Soak_Stream);
+  Host_AddReport(Soak_Report);
+  clock_gettime(CLOCK_MONOTONIC, &wallStart);
+
+  fprintf(stderr, "soak: sysCnt %lu, secCnt %lu, wrap in %u s\n",
+          (unsigned long)sysCnt, (unsigned long)secCnt, wrap);
+  return Firmware_Main();
+}
+
+
+/**
+ * @brief   Bus hook, times the LED toggles. Pulls nothing.
+ * @retval  (uint8_t) lines pulled low
+ */
+static uint8_t Soak_Bus(uint8_t drive, uint8_t strong, uint8_t pins) {
+  uint8_t level = (strong & _BV(SOAK_LED)) ? 1 : (drive & _BV(SOAK_LED)) ? 0 : 0xff;
+  uint64_t now = Host_Cycles();
+  (void)pins;
+
+  if ((level != 0xff) && (level != ledLevel)) {
+    if ((ledLevel != 0xff) && ledAt) {
+      int32_t ms = (int32_t)Soak_Ms(now - ledAt);
+      Soak_Check(&chkLed, ms, (uint32_t)abs(ms - LED_SRV_STEP) <= SOAK_JITTER_MS, "");
+    }
+    if (ledLevel != 0xff) ledAt = now;
+    ledLevel = level;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Stream observer, checks each printf once it has been shown:
+ *          its period, the second count against the clock, the display
+ *          text and the temperature against the sensors.
+ * @retval  none
+ */
+static void Soak_Stream(const char* buf, size_t len, uint8_t done) {
+  static char text[64];
+
+  /* --- The first display line shows the last printf once the I2C queue --- */
+  /* --- has sent it, checked as the next one begins --- */
+  if (!done) {
+    if (!prnAt) return;
+    char lcd[(DSPM_LCD_COLS + 1) * DSPM_LCD_ROWS + 1];
+    DSPM_LcdText(lcd);
+    size_t shown = (strlen(text) < DSPM_LCD_COLS) ? strlen(text) : DSPM_LCD_COLS;
+    uint8_t ok = !strncmp(lcd, text, shown);
+    for (size_t i = shown; i < DSPM_LCD_COLS; i++) ok &= (lcd[i] == ' ');
+    Soak_Check(&chkLcd, (int32_t)shown, ok, text);
+    return;
+  }
+
+  uint64_t now = Host_Cycles();
+  size_t n = (len < sizeof(text) - 1) ? len : sizeof(text) - 1;
+  memcpy(text, buf, n);
+  text[n] = 0;
+  char* nl = strchr(text, '\n');
+  if (nl) *nl = 0;
+
+  /* --- Period of the print task --- */
+  if (prnAt) {
+    int32_t ms = (int32_t)Soak_Ms(now - prnAt);
+    Soak_Check(&chkPrint, ms, (uint32_t)abs(ms - PRNT_SRV_STEP) <= SOAK_JITTER_MS, text);
+  }
+  prnAt = now;
+
+  /* --- Seconds shown against the ones elapsed on the clock --- */
+  unsigned long sec;
+  if (sscanf(text, "sec:%lu", &sec) == 1) {
+    uint32_t expect = secStart + (uint32_t)(Soak_Ms(now) / 1000);
+    int32_t drift = (int32_t)((uint32_t)sec - expect);
+    Soak_Check(&chkSec, drift, abs(drift) <= 1, text);
+  }
+
+  /* --- Sensor cadence and the reading, once the first round is done --- */
+  owm_stat_t* st = OWM_Stat();
+  if (st->conversions != convCnt) {
+    convCnt = st->conversions;
+    convAt = now;
+  }
+  if (Soak_Ms(now) > 3 * TMPR_SRV_STEP) {
+    int32_t gap = (int32_t)Soak_Ms(now - convAt);
+    Soak_Check(&chkSensor, gap, gap <= 2 * TMPR_SRV_STEP, text);
+
+    int t, frac;
+    if (sscanf(text, "T:%d.%d", &t, &frac) == 2) {
+      int16_t shownT = (int16_t)(t * 16 + (frac * 16 + 50) / 100);
+      uint8_t ok = 0;
+      for (uint8_t i = 0; i < OWM_DeviceCount(); i++) ok |= (OWM_Device(i)->temp == shownT);
+      Soak_Check(&chkTemp, shownT, ok, text);
+    }
+  }
+
+  /* --- Progress of long runs --- */
+  if (Soak_Ms(now) >= progressAt + SOAK_PROGRESS_S * 1000ULL) {
+    progressAt = Soak_Ms(now);
+    double wall = Soak_Wall();
+    fprintf(stderr, "soak: %llu s, %.0f sim s per s, sec:%lu, %u failed\n",
+            (unsigned long long)(progressAt / 1000), (wall > 0) ? progressAt / 1000.0 / wall : 0.0,
+            (unsigned long)secCnt, chkLed.fails + chkPrint.fails + chkSec.fails + chkLcd.fails + chkTemp.fails + chkSensor.fails);
+  }
+}
+
+
+/**
+ * @brief   Counts one observation and reports a failed one.
+ * @param   c the check
+ * @param   val observed value
+ * @param   ok the value is within the limits
+ * @param   ctx text printed when it happened
+ * @retval  none
+ */
+static void Soak_Check(soak_chk_t* c, int32_t val, uint8_t ok, const char* ctx) {
+  c->count++;
+  if (val < c->min) c->min = val;
+  if (val > c->max) c->max = val;
+  if (ok) return;
+
+  c->fails++;
+  if (failShown++ < SOAK_FAIL_SHOWN) {
+    fprintf(stderr, "soak: FAIL %s = %d at %.3f s, sysCnt %lu, \"%s\"\n", c->name, val,
+            Soak_Ms(Host_Cycles()) / 1000.0, (unsigned long)sysCnt, ctx);
+  }
+}
+
+
+/**
+ * @brief   End of run report.
+ * @param   out report stream
+ * @retval  (uint8_t) number of failed checks, saturated
+ */
+static uint8_t Soak_Report(FILE* out) {
+  const soak_chk_t* chk[] = {&chkLed, &chkPrint, &chkSec, &chkLcd, &chkTemp, &chkSensor};
+  uint32_t fails = 0;
+  double sim = Soak_Ms(Host_Cycles()) / 1000.0;
+  double wall = Soak_Wall();
+
+  fprintf(out, "soak: %.0f s simulated, %.0f sim s per s, sysCnt %lu, secCnt %lu\n",
+          sim, (wall > 0) ? sim / wall : 0.0, (unsigned long)sysCnt, (unsigned long)secCnt);
+  for (uint8_t i = 0; i < sizeof(chk) / sizeof(chk[0]); i++) {
+    fprintf(out, "soak: %-18s %8u checks %6u failed  min %d max %d\n", chk[i]->name,
+            chk[i]->count, chk[i]->fails, chk[i]->count ? chk[i]->min : 0, chk[i]->count ? chk[i]->max : 0);
+    if (!chk[i]->count && (sim > 3 * TMPR_SRV_STEP / 1000)) fails++;
+    fails += chk[i]->fails;
+  }
+  fprintf(out, "soak: %s\n", fails ? "FAILED" : "passed");
+  return (fails > 0xff) ? 0xff : (uint8_t)fails;
+}
+
+
+/**
+ * @brief   Simulated time.
+ * @param   c cycles
+ * @retval  (uint64_t) milliseconds
+ */
+static uint64_t Soak_Ms(uint64_t c) {
+  return c / (F_CPU / 1000);
+}
+
+
+/**
+ * @brief   Host time since the start.
+ * @retval  (double) seconds
+ */
+static double Soak_Wall(void) {
+  struct timespec now;
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return (now.tv_sec - wallStart.tv_sec) + (now.tv_nsec - wallStart.tv_nsec) / 1e9;
+}
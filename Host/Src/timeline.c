@@ -0,0 +1,204 @@
+/*
+ * Filename: timeline.c
+ * Description: The event trace decoder for the host. Reads an EEPROM image
+ *              with a frozen trace ring and prints the events on a time
+ *              line, then the task run times and the main loop latencies.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: Linux host (MicroChip ATTiny85 emulation)
+ * Created: 17.10.2026 03:56:12 PM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include "main.h"
+
+#include <string.h>
+
+
+#define TL_ENV_IMAGE      "SML_TRACE"       // EEPROM image holding the ring
+#define TL_TASKS          16                // task index is 4 bits wide
+
+#define TL_T1_PER_T0      128               // Timer1 counts per Timer0 count
+#define TL_WRAP           (65536UL * TL_T1_PER_T0)
+
+
+/* Private constants */
+static const char* busName[BUS_COUNT] = {"1-Wire", "I2C", "TM1637"};
+static const char* whyName[] = {"Trace_Freeze() call", "long dispatch"};
+
+/* Private variables */
+static trace_hdr_t hdr;
+static trace_ev_t  ev[TRACE_SIZE];
+
+/* Private function definitions */
+static uint8_t TL_Load(const char*);
+static uint32_t TL_Time(const trace_ev_t*);
+static void TL_Name(uint8_t, char*, size_t);
+static double TL_Us(uint64_t);
+
+
+
+/**
+ * @brief   Loads the ring, prints the time line and the latency summary.
+ * @retval  (int) process exit code
+ */
+int main(void) {
+  const char* image = getenv(TL_ENV_IMAGE);
+
+  if (!image || TL_Load(image)) {
+    fprintf(stderr, "timeline: %s=<EEPROM image with an event trace> is needed\n", TL_ENV_IMAGE);
+    return 1;
+  }
+
+  printf("timeline: %u events, frozen by a %s", hdr.count,
+         (hdr.why < sizeof(whyName) / sizeof(whyName[0])) ? whyName[hdr.why] : "?");
+  if (hdr.why == TRACE_WHY_LONG) printf(" of task %u", hdr.task);
+  printf("\n%12s %10s  %s\n", "time, us", "+us", "event");
+
+  uint64_t now = 0;
+  uint32_t prev = TL_Time(&ev[0]);
+  uint64_t taskIn[TL_TASKS];
+  uint64_t taskMax[TL_TASKS] = {0};
+  uint64_t taskSum[TL_TASKS] = {0};
+  uint16_t taskRuns[TL_TASKS] = {0};
+  uint8_t  taskOpen[TL_TASKS] = {0};
+  uint64_t tickAt = 0, sleepAt = 0;
+  uint64_t wakeMax = 0, dispMax = 0, sleepSum = 0;
+  uint8_t  tickOpen = 0, asleep = 0;
+
+  for (uint8_t i = 0; i < hdr.count; i++) {
+    uint32_t t = TL_Time(&ev[i]);
+    uint32_t dt = (t - prev) % TL_WRAP;
+    uint8_t type = TRACE_TYPE(ev[i].id);
+    uint8_t arg = TRACE_ARG(ev[i].id);
+    char name[32];
+
+    now += dt;
+    prev = t;
+    TL_Name(ev[i].id, name, sizeof(name));
+    printf("%12.1f %+10.1f  %s\n", TL_Us(now), TL_Us(dt), name);
+
+    switch (type) {
+      case TRACE_TASK_IN:
+        taskIn[arg] = now;
+        taskOpen[arg] = 1;
+        /* --- Dispatch latency, the tick interrupt to its first task --- */
+        if (tickOpen && (now - tickAt > dispMax)) dispMax = now - tickAt;
+        tickOpen = 0;
+        break;
+
+      case TRACE_TASK_OUT:
+        if (taskOpen[arg]) {
+          uint64_t run = now - taskIn[arg];
+          taskSum[arg] += run;
+          taskRuns[arg]++;
+          if (run > taskMax[arg]) taskMax[arg] = run;
+          taskOpen[arg] = 0;
+        }
+        break;
+
+      case TRACE_ISR:
+        if (arg == TRACE_VEC_TIM0) {
+          tickAt = now;
+          tickOpen = 1;
+        }
+        break;
+
+      case TRACE_SLEEP:
+        sleepAt = now;
+        asleep = 1;
+        break;
+
+      case TRACE_WAKE:
+        /* --- Wake-up latency, the tick interrupt to the main loop --- */
+        if (tickOpen && (now - tickAt > wakeMax)) wakeMax = now - tickAt;
+        if (asleep) sleepSum += now - sleepAt;
+        asleep = 0;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  printf("timeline: %.1f us traced, %.1f us asleep\n", TL_Us(now), TL_Us(sleepSum));
+  for (uint8_t i = 0; i < TL_TASKS; i++) {
+    if (!taskRuns[i]) continue;
+    printf("timeline: task %u, %u runs, avg %.1f max %.1f us\n", i, taskRuns[i],
+           TL_Us(taskSum[i]) / taskRuns[i], TL_Us(taskMax[i]));
+  }
+  printf("timeline: tick to wake-up max %.1f us, tick to dispatch max %.1f us\n",
+         TL_Us(wakeMax), TL_Us(dispMax));
+  return 0;
+}
+
+
+/**
+ * @brief   Reads the ring out of the EEPROM image.
+ * @param   path image file
+ * @retval  (uint8_t) status of operation
+ */
+static uint8_t TL_Load(const char* path) {
+  uint8_t ee[E2END + 1];
+  FILE* f = fopen(path, "rb");
+
+  if (!f) return 1;
+  size_t n = fread(ee, 1, sizeof(ee), f);
+  fclose(f);
+  if (n != sizeof(ee)) return 1;
+
+  memcpy(&hdr, &ee[EE_TRACE_ADDR], sizeof(hdr));
+  if ((hdr.magic != TRACE_MAGIC) || !hdr.count || (hdr.count > TRACE_SIZE)) return 1;
+  memcpy(ev, &ee[EE_TRACE_ADDR + sizeof(hdr)], hdr.count * sizeof(trace_ev_t));
+  return 0;
+}
+
+
+/**
+ * @brief   Event time out of its Timer0 and Timer1 reads.
+ * @param   e event
+ * @retval  (uint32_t) Timer1 counts, wraps at TL_WRAP
+ */
+static uint32_t TL_Time(const trace_ev_t* e) {
+  uint16_t t0 = e->t0;
+
+  /* --- Timer0 counted between the Timer1 and the Timer0 reads --- */
+  if ((t0 ^ (e->t1 >> 7)) & 1) t0--;
+  return (uint32_t)t0 * TL_T1_PER_T0 + (e->t1 & 0x7f);
+}
+
+
+/**
+ * @brief   Gives the event name.
+ * @param   id event type and argument
+ * @param   buf name buffer
+ * @param   len buffer size
+ * @retval  none
+ */
+static void TL_Name(uint8_t id, char* buf, size_t len) {
+  uint8_t arg = TRACE_ARG(id);
+  const char* bus = (arg < BUS_COUNT) ? busName[arg] : "?";
+
+  switch (TRACE_TYPE(id)) {
+    case TRACE_TASK_IN:    snprintf(buf, len, "task %u in", arg); break;
+    case TRACE_TASK_OUT:   snprintf(buf, len, "task %u out", arg); break;
+    case TRACE_ISR:        snprintf(buf, len, "isr %u", arg); break;
+    case TRACE_BUS_START:  snprintf(buf, len, "%s start", bus); break;
+    case TRACE_BUS_STOP:   snprintf(buf, len, "%s stop", bus); break;
+    case TRACE_CONV_BEGIN: snprintf(buf, len, "conversion begin"); break;
+    case TRACE_CONV_END:   snprintf(buf, len, "conversion end"); break;
+    case TRACE_SLEEP:      snprintf(buf, len, "sleep"); break;
+    case TRACE_WAKE:       snprintf(buf, len, "wake"); break;
+    default:               snprintf(buf, len, "0x%02x", id); break;
+  }
+}
+
+
+/**
+ * @brief   Timer1 counts in microseconds.
+ * @param   c counts
+ * @retval  (double) microseconds
+ */
+static double TL_Us(uint64_t c) {
+  return (double)c * TRACE_NS_PER_CNT / 1000.0;
+}
@@ -0,0 +1,56 @@
+/*
+ * Filename: bus_stat.h
+ * Description: A set of definitions for the bus utilization counters.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:37:05 AM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef BUS_STAT_H_
+#define BUS_STAT_H_
+
+
+#include "main.h"
+
+
+/* --- Counted buses, the same order as the pin trace ones --- */
+#define BUS_OW          0
+#define BUS_I2C         1
+#define BUS_DD          2 // TM1637 digital display
+#define BUS_COUNT       3
+
+/* --- Busy time runs on Timer0, the system tick counter @ clk/1024 --- */
+#define BUS_US_PER_CNT  IDLE_US_PER_CNT
+
+/* --- Buses whose operations are far shorter than a Timer0 count, their busy --- */
+/* --- time is the wire time the driver gives with each byte --- */
+#define BUS_BYTE_TIMED  _BV(BUS_I2C)
+
+
+/* Bus utilization since the last reset */
+typedef struct {
+  uint16_t  trans;    // transactions started
+  uint16_t  bytes;    // bytes sent and received
+  uint16_t  fails;    // NACKs, missing presence pulses
+  uint16_t  longest;  // longest transaction, Timer0 counts
+  uint32_t  busy;     // time the bus code ran, us
+  uint32_t  pad;      // _delay_us padding in the busy time, us
+  uint32_t  window;   // time since the reset, Timer0 counts
+} bus_stat_t;
+
+
+/* Exported functions */
+void Init_BusStat(void);
+void BusStat_Open(uint8_t);
+void BusStat_Close(uint8_t);
+void BusStat_Begin(uint8_t);
+void BusStat_End(uint8_t);
+void BusStat_Byte(uint8_t);
+void BusStat_ByteTime(uint8_t, uint8_t);
+void BusStat_Fail(uint8_t);
+void BusStat_Snapshot(uint8_t, bus_stat_t*);
+void BusStat_Reset(uint8_t);
+
+
+#endif /* BUS_STAT_H_ */
@@ -14,18 +14,37 @@
 #include "main.h"
 #include "fonts.h"
 
-// #define DSPL_SSD1315
+/* --- Panel drivers built in, the boot scan attaches the panels that answer --- */
+#define DSPL_SSD1315
 #define DSPL_WH1602
+
+/* --- Panels the text is mirrored to, the first ones found in the driver order --- */
+#define DSPL_PANELS         2
+
+/* --- Characters waiting for the I2C queue, a power of two, the longest printed line and its marks fit --- */
+#define DSPL_TEXT_SIZE      64
+
+
+struct i2c_xfer;
+
+/* A panel driver, a table of them in flash is probed at boot */
+typedef struct {
+  uint8_t   addr;                               // 7-bit I2C address probed
+  uint8_t   (*init)(void);                      // blocking set-up, 0 = ready
+  uint8_t   (*putc)(struct i2c_xfer*, uint8_t); // next transaction of a character, 0 = done
+  uint8_t   (*flush)(struct i2c_xfer*);         // next transaction at the line end, 0 = done, or NULL
+  uint8_t   (*clear)(struct i2c_xfer*);         // next transaction of a clear, 0 = done
+} dspl_drv_t;
    
 /* Exported functions prototypes */
 uint8_t Init_Display(void);
 int putc_dspl(char, FILE*);
-void WH1602_Write(uint8_t, uint8_t, const char*);
-uint8_t SSD1315_WriteBuf(const uint8_t*, uint16_t, uint8_t* );
+uint16_t Dspl_Drops(void);
 
 
 /* --- WH0802A commands --- */
 #define _1602A_ADDR_        0x27 // WH1602 I2C Address
+#define _1602A_SPEED_       I2C_SPEED_SM // PCF8574 backpack, rated for 100 kHz
 #define _1602A_8BBUS_       0x03 // 8-bit initial bus initialization
 #define _1602A_CURUPLEFT_   0x02 // Cursor positioin up an left
 #define	_1602A_4BBUS2L_     0x28 // 4-bit bus, LCD of 2 lines
@@ -34,6 +53,7 @@ uint8_t SSD1315_WriteBuf(const uint8_t*, uint16_t, uint8_t* );
 #define _1602A_1LS_         0x80 // Position at 1-st line, start 
 #define _1602A_2LS_         0xc0 // Position ar 2-nd line, start
 #define _1602A_NOCMD_       0x00 // No command
+#define _1602A_SYNC_STEPS_  6    // init commands up to the display on, resent after a lost write
 
 /* --- WH0802A control parameters --- */
 #define _1602A_Bl           3
@@ -50,8 +70,24 @@ uint8_t SSD1315_WriteBuf(const uint8_t*, uint16_t, uint8_t* );
 
 /* --- SSD1315 commands --- */
 #define _SSD1315_ADDR_      0x3c // SSD1315 I2C Address
+#define _SSD1315_SPEED_     I2C_SPEED_FMP // I2C speed profile
 #define _SSD1315_Co_        7 // Co bit
 #define _SSD1315_DC_        6 // DC bit (1 - data, 0 - command)
+#define _SSD1315_CMD_       ((uint8_t)(~_BV(_SSD1315_Co_)&~_BV(_SSD1315_DC_))) // control byte, commands follow
+#define _SSD1315_DATA_      ((uint8_t)(_BV(_SSD1315_DC_)&~_BV(_SSD1315_Co_)))  // control byte, data follow
+
+/* --- SSD1315 glyph of the font built in --- */
+#if defined(FONT_DOT_10X14)
+  #define _SSD1315_GLYPH_(c)  (font_dot_10x14[(c) - 32])
+  #define _SSD1315_GLYPHLEN_  sizeof(font_dot_10x14_t)
+  #define _SSD1315_GLYPHW_    12 // columns
+  #define _SSD1315_GLYPHH_    2  // pages
+#else
+  #define _SSD1315_GLYPH_(c)  (font_dot_5x7[(c) - 32])
+  #define _SSD1315_GLYPHLEN_  sizeof(font_dot_5x7_t)
+  #define _SSD1315_GLYPHW_    6
+  #define _SSD1315_GLYPHH_    1
+#endif
 
 /* --- Display end of line parameters --- */
 #define _0DCF_              0
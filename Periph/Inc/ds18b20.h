@@ -16,7 +16,7 @@
 
 
 /* Flags definitions */
-#define _DSDF_            0 // Delay Flag
+#define _DSDF_            0 // Delay Flag, a conversion or copy holds the bus
 
 
 /* --- DS18B20 spwcific commands --- */
@@ -30,9 +30,9 @@
 /* Exported functions */
 uint8_t DS18B20_ReadScrachpad(uint8_t*, uint8_t*);
 uint8_t DS18B20_WriteScratchpad(uint8_t*, uint8_t*);
-uint8_t DS18B20_ConvertTemperature(uint8_t*);
-uint8_t DS18B20_CopyScratchpad(uint8_t*);
-uint8_t DS18B20_RecallEeprom(uint8_t*);
+uint8_t DS18B20_ConvertTemperature(pt_t*, uint8_t*);
+uint8_t DS18B20_CopyScratchpad(pt_t*, uint8_t*);
+uint8_t DS18B20_RecallEeprom(pt_t*, uint8_t*);
 
 volatile uint8_t* Get_DSREG(void);
 
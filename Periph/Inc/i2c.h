@@ -16,7 +16,7 @@
 /* Flags definitions */
 #define _I2C_ACKF_    0 // ACK/NACK Flag
 #define _I2C_RWF_     1 // Read/Write Flag (0 - write, 1 - read)
-#define _I2C_BERF_    2 // Bus Error Flag
+#define _I2C_BERF_    2 // Bus Error Flag, the next transaction recovers the bus first
 
 
 #define I2CDDR    DDRB
@@ -38,6 +38,119 @@
 #define	I2C_READ  FLAG_SET(*_i2creg, _I2C_RWF_)
 
 
+/* --- Bus speed profiles, UM10204 timing, picked per device or at run time --- */
+#define I2C_SPEED_SM      0 // Standard-mode, 100 kHz
+#define I2C_SPEED_FM      1 // Fast-mode, 400 kHz
+#define I2C_SPEED_FMP     2 // Fast-mode Plus, 1 MHz
+#define I2C_SPEED_COUNT   3
+#define I2C_SPEED_DEFAULT I2C_SPEED_SM // till a device asks for its own
+
+/* --- Waits are delay loops of 3 cycles, less the cycles of the code around --- */
+/* --- them. The HAL charges the register accesses only, so it has its own --- */
+#define I2C_LOOP_CYC      3
+#if defined(HOST_BUILD)
+  #define I2C_OVH_LOW     2 // SCL fall to rise: USIOIF test, strobe
+  #define I2C_OVH_HIGH    2 // SCL rise to fall: SCL test, strobe
+  #define I2C_OVH_COND    1 // a port write
+#else
+  #define I2C_OVH_LOW     8 // rjmp, sbic USIOIF, lds and test of the count, out
+  #define I2C_OVH_HIGH    7 // sbis SCL taken once, lds and test of the count, out
+  #define I2C_OVH_COND    5 // sbi/cbi, lds and test of the count
+#endif
+
+#define I2C_NS_CYC(ns)    (((uint32_t)(ns) * (F_CPU / 1000000UL) + 999) / 1000)
+#define I2C_LOOPS(ns, ovh) ((I2C_NS_CYC(ns) > (ovh)) ? \
+                            (uint8_t)((I2C_NS_CYC(ns) - (ovh) + I2C_LOOP_CYC - 1) / I2C_LOOP_CYC) : 0)
+/* --- Wire time of a byte, 9 clocks, us --- */
+#define I2C_BYTE_US(hz)   ((uint8_t)((9000000UL + (hz) / 2) / (hz)))
+/* --- Queue bytes per step, 9 clocks each, in half a Timer0 count. Standard-mode --- */
+/* --- still takes one byte, so its steps run past a whole Timer0 count --- */
+#define I2C_STEP_BYTES(hz) (((IDLE_US_PER_CNT / 2) * (hz) / 9000000UL) ? \
+                            (uint8_t)((IDLE_US_PER_CNT / 2) * (hz) / 9000000UL) : 1)
+
+/* --- tLOW takes what the period leaves over the minimum tHIGH --- */
+#define I2C_T_LOW(hz, tLow, tHigh) (((1000000000UL / (hz)) - (tHigh) > (tLow)) ? \
+                            (1000000000UL / (hz)) - (tHigh) : (tLow))
+
+/* --- A profile out of the clock and the minimum times, ns --- */
+#define I2C_PROFILE(hz, tLow, tHigh, tSuSta, tHdSta, tSuSto, tBuf) { \
+  I2C_LOOPS(I2C_T_LOW(hz, tLow, tHigh), I2C_OVH_LOW), I2C_LOOPS(tHigh, I2C_OVH_HIGH), \
+  I2C_LOOPS(tSuSta, I2C_OVH_COND), I2C_LOOPS(tHdSta, I2C_OVH_COND), \
+  I2C_LOOPS(tSuSto, I2C_OVH_COND), I2C_LOOPS(tBuf, I2C_OVH_COND), \
+  I2C_STEP_BYTES(hz), I2C_BYTE_US(hz) }
+
+#define I2C_PROFILE_SM    I2C_PROFILE(100000UL,  4700, 4000, 4700, 4000, 4000, 4700)
+#define I2C_PROFILE_FM    I2C_PROFILE(400000UL,  1300,  600,  600,  600,  600, 1300)
+#define I2C_PROFILE_FMP   I2C_PROFILE(1000000UL,  500,  260,  260,  260,  260,  500)
+
+
+/* Speed profile, delay loop counts */
+typedef struct {
+  uint8_t   low;      // tLOW
+  uint8_t   high;     // tHIGH, from SCL seen high
+  uint8_t   suSta;    // tSU;STA
+  uint8_t   hdSta;    // tHD;STA
+  uint8_t   suSto;    // tSU;STO, from SCL seen high
+  uint8_t   buf;      // tBUF
+  uint8_t   step;     // queue bytes per step
+  uint8_t   byteUs;   // wire time of a byte, for the bus statistics
+} i2c_speed_t;
+
+
+/* --- Transaction queue, stepped by the Timer0 compare B interrupt --- */
+#define I2C_QUEUE_SIZE    4   // transactions waiting, a power of two
+#define I2C_STEP_CNT      1   // Timer0 counts between steps, 64 us each
+#define I2C_GAP(us)       ((us) / IDLE_US_PER_CNT) // idle steps after the STOP, the first step is free
+
+/* Transaction status, a zeroed transaction is done */
+#define I2C_XS_DONE       0
+#define I2C_XS_NACK       1 // a data byte was not acknowledged
+#define I2C_XS_ANACK      2 // no device answered the address
+#define I2C_XS_TIMEOUT    3 // SCL held low past I2C_STRETCH_US
+#define I2C_XS_BUS        4 // SDA stuck low after the recovery clocks
+#define I2C_XS_BACKOFF    5 // not sent, the device backs off after failures
+#define I2C_XS_QUEUED     6
+#define I2C_XS_BUSY       7
+#define I2C_PENDING(x)    ((x)->status >= I2C_XS_QUEUED)
+
+/* --- Bus faults --- */
+#define I2C_STRETCH_US    100 // longest clock stretch, a held SCL is a fault past it
+#define I2C_RECOVER_CLK   9   // clocks to free a slave holding SDA, UM10204 3.1.16
+
+/* --- Per-device back-off, a failed device is skipped for a time doubling --- */
+/* --- with each failure in a row, its next transaction is the retry --- */
+#define I2C_DEV_SLOTS     4   // devices with a failure record
+#define I2C_BACKOFF_MS    250 // after the first failure
+#define I2C_BACKOFF_MAX   5   // doublings, 8 s at most
+
+/* --- Boot scan, the reserved addresses of UM10204 3.1.12 are left out --- */
+#define I2C_ADDR_FIRST    0x08
+#define I2C_ADDR_LAST     0x77
+
+/* Transaction flags */
+#define I2C_XF_CTRL       0x01 // ctrl goes ahead of the write buffer
+#define I2C_XF_PGM        0x02 // the write buffer is in flash
+#define I2C_XF_FILL       0x04 // the write buffer is one byte, sent wrLen times
+
+
+/* --- A queued transaction: START, address, ctrl and write bytes, then a --- */
+/* --- repeated START and the read bytes, STOP. Each step of the interrupt --- */
+/* --- moves the profile's step bytes, the buffers belong to the queue until --- */
+/* --- it is done --- */
+typedef struct i2c_xfer {
+  uint8_t           addr;     // 7-bit slave address
+  uint8_t           flags;    // I2C_XF_*
+  uint8_t           ctrl;
+  uint8_t           wrLen;
+  uint8_t           rdLen;
+  uint8_t           gap;      // idle steps after the STOP, I2C_GAP()
+  uint8_t           speed;    // I2C_SPEED_*, a zeroed transaction runs Standard-mode
+  const uint8_t*    wr;
+  uint8_t*          rd;
+  volatile uint8_t  status;   // I2C_XS_*
+  void            (*done)(struct i2c_xfer*); // called by the interrupt, may queue again
+} i2c_xfer_t;
+
 
 
 void I2C_Start(void);
@@ -48,8 +161,26 @@ void I2C_SendAckNack(void);
 void I2C_SendAddress(uint8_t);
 void I2C_SendByte(uint8_t);
 uint8_t I2C_ReceiveByte(void);
+uint8_t I2C_Submit(i2c_xfer_t*);
+void I2C_Step(void);
+void I2C_SetSpeed(uint8_t);
+uint8_t I2C_WriteBurst(uint8_t, uint8_t, const void*, uint16_t, uint8_t);
+uint8_t I2C_Recover(void);
+uint8_t I2C_Ready(uint8_t);
+uint8_t I2C_Scan(void);
+uint8_t I2C_Found(uint8_t);
 
 volatile uint8_t* Get_I2CREG(void);
+uint8_t Get_I2CSpeed(void);
+
+
+/* --- Blocking bursts, a START, the bytes and a STOP, return I2C_XS_* --- */
+#define I2C_Write(addr, buf, len, flags) \
+  I2C_WriteBurst((addr), 0, (buf), (len), (flags) & ~I2C_XF_CTRL)
+#define I2C_Write_P(addr, buf, len, flags) \
+  I2C_WriteBurst((addr), 0, (buf), (len), ((flags) & ~I2C_XF_CTRL) | I2C_XF_PGM)
+#define I2C_WriteCtrl(addr, ctrl, buf, len, flags) \
+  I2C_WriteBurst((addr), (ctrl), (buf), (len), (flags) | I2C_XF_CTRL)
 
 
 #endif /* I2C_H_ */
\ No newline at end of file
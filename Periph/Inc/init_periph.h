@@ -26,18 +26,45 @@
 /* --- Reduce Power Consumption (16.2.2 p.120) --- */
 /* --- Power reduce (7.5.2 p.38) --- */
 #define _INIT_MCU do { \
-  MCUSR   |= _BV(SE); \
+  MCUCR   |= _BV(SE); \
   ACSR    |= _BV(ACD); \
   PRR     |= _BV(PRADC)|_BV(PRTIM1); \
 } while (0)  
 
 
 /* --- Timers --- */
-/* --- Timer0 counts ~1ms system tick --- */
+/* --- Timer0 counts 1ms system tick in CTC mode (11.7.2 p.72) --- */
+/* --- OCR0A is reloaded by the ISR with 15 or 16 counts --- */
 #define _INIT_TIMERS do { \
-  TCCR0B  |= _BV(CS02); \
-  TIMSK   |= _BV(TOIE0); \
-  TCNT0   = SYS_TICK_THOLD; \
+  TCCR0A  = _BV(WGM01); \
+  TCCR0B  = _BV(CS02)|_BV(CS00); \
+  OCR0A   = (uint8_t)((SYS_TICK_Q16 >> 16) - 1); \
+  TIMSK   |= _BV(OCIE0A); \
+} while (0)
+
+
+/* --- Timer1 free runs @ clk/64 for the task profiler --- */
+#define _INIT_PROF do { \
+  PRR     &= ~_BV(PRTIM1); \
+  TCCR1   = _BV(CS12)|_BV(CS11)|_BV(CS10); \
+  TIMSK   |= _BV(TOIE1); \
+} while (0)
+
+
+/* --- Timer1 free runs @ clk/32 for the pin trace, 2 us per count --- */
+/* --- The pin change interrupt is masked by PCMSK until a capture arms --- */
+#define _INIT_PTRACE do { \
+  PRR     &= ~_BV(PRTIM1); \
+  TCCR1   = _BV(CS12)|_BV(CS11); \
+  PCMSK   = 0; \
+  GIMSK   |= _BV(PCIE); \
+} while (0)
+
+
+/* --- Timer1 free runs @ clk/8 for the event trace, 0.5 us per count --- */
+#define _INIT_TRACE do { \
+  PRR     &= ~_BV(PRTIM1); \
+  TCCR1   = _BV(CS12); \
 } while (0)
 
 
@@ -57,6 +84,7 @@
   USIDR   = 0xff; \
   USICR   = _BV(USIWM1)|_BV(USICS1)|_BV(USICLK); \
   USISR   = _BV(USISIF)|_BV(USIOIF)|_BV(USIPF)|_BV(USIDC); \
+  I2C_SetSpeed(I2C_SPEED_DEFAULT); \
 } while (0)
 
 
@@ -45,6 +45,9 @@
 #define EE_OW_ADDR        0x0040
 #define EE_OW_ALAD        0x00c0
 
+/* --- Devices kept, the count lives in a nibble --- */
+#define OW_DEV_MAX        15
+
 
 /* --- OneWire device spwcific commands --- */
 #define SearchROM         0xf0
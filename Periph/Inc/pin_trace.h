@@ -0,0 +1,94 @@
+/*
+ * Filename: pin_trace.h
+ * Description: A set of definitions for the optional bus pin trace.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:14:27 AM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef PIN_TRACE_H_
+#define PIN_TRACE_H_
+
+
+#include "main.h"
+
+
+/* --- Pin change capture of the bus lines, Timer1 @ clk/32 --- */
+// #define PIN_TRACE
+
+#if defined(PIN_TRACE) && defined(SCHED_PROFILE)
+  #error "PIN_TRACE and SCHED_PROFILE both run Timer1"
+#endif
+
+
+/* --- Capture ring, bytes, one byte per edge --- */
+/* --- A DS18B20 scratchpad read with its MatchROM takes 155 --- */
+#define PTRACE_SIZE       160
+#define PTRACE_US_PER_CNT (32000000UL / F_CPU) // microseconds per Timer1 count
+#define PTRACE_SRV_STEP   250                  // frozen capture dump step, ticks
+#define PTRACE_DUMP_CHUNK 16                   // EEPROM bytes written per dump step
+
+/* --- EEPROM image of a frozen capture, the header goes in last --- */
+#define EE_PTRACE_ADDR    0x0140
+#define PTRACE_MAGIC      0xa7
+
+/* --- Traced buses, the arming one selects the pins --- */
+#define PTRACE_OW         0
+#define PTRACE_I2C        1
+#define PTRACE_DD         2 // TM1637 digital display
+#define PTRACE_BUSES      3
+
+/* --- Traced pins in entry order --- */
+#define PTRACE_PINS       (_BV(PB0)|_BV(PB2)|_BV(PB3)|_BV(PB4))
+
+/* --- Failures that freeze the capture --- */
+#define PTRACE_SITE_NONE      0
+#define PTRACE_SITE_PRESENCE  1 // no presence pulse after a reset
+#define PTRACE_SITE_SEARCH    2 // no device answered a ROM search bit
+#define PTRACE_SITE_ROMCRC    3 // ROM code CRC mismatch
+#define PTRACE_SITE_PADCRC    4 // scratchpad CRC mismatch
+#define PTRACE_SITE_NACK      5 // I2C NACK
+#define PTRACE_SITE_DDNACK    6 // TM1637 NACK
+
+
+/* --- An edge: [7:6] pin index in PTRACE_PINS, [5] device pulled the --- */
+/* --- line low, else the line rose, [4:0] Timer1 counts since the --- */
+/* --- previous edge on the traced pins, PTRACE_DT_MAX = that or more. --- */
+/* --- The MCU pulling a line low is not stored, its time is the --- */
+/* --- reference of the next entry --- */
+#define PTRACE_PIN(e)     ((e) >> 6)
+#define PTRACE_FALL(e)    ((e) & 0x20)
+#define PTRACE_DT(e)      ((e) & 0x1f)
+#define PTRACE_DT_MAX     0x1f
+
+
+/* --- Capture header, EEPROM image layout --- */
+typedef struct {
+  uint8_t   magic;
+  uint8_t   bus;      // bus of the captured transaction
+  uint16_t  arms;     // transactions on the bus since reset, this one included
+  uint8_t   levels;   // traced pin levels when armed
+  uint8_t   count;    // entries kept
+  uint8_t   lost;     // entries past the ring, saturated
+  uint8_t   site;     // failure that froze the capture
+} ptrace_hdr_t;
+
+
+#if defined(PIN_TRACE)
+  /* Exported functions */
+  void Init_PinTrace(void);
+  void PinTrace_Arm(uint8_t);
+  void PinTrace_Freeze(uint8_t);
+  const ptrace_hdr_t* PinTrace_Header(void);
+  uint8_t PinTrace_Scheduler(void);
+
+  #define PTRACE_ARM(bus)     PinTrace_Arm(bus)
+  #define PTRACE_FREEZE(site) PinTrace_Freeze(site)
+#else
+  #define PTRACE_ARM(bus)     do {} while (0)
+  #define PTRACE_FREEZE(site) do {} while (0)
+#endif
+
+
+#endif /* PIN_TRACE_H_ */
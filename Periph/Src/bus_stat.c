@@ -0,0 +1,159 @@
+/*
+ * Filename: bus_stat.c
+ * Description: The file contains the bus utilization counters. The bus
+ *              drivers mark their transactions and operations, the time
+ *              comes from Timer0 and the _delay_us total, or from the
+ *              wire time of the bytes on a byte timed bus.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:37:05 AM
+ * Author: Dmitry Slobodchikov
+ */
+#include "bus_stat.h"
+
+/* Private variables */
+static bus_stat_t stat[BUS_COUNT];    // the window field holds the reset time
+static uint8_t    open[BUS_COUNT];    // a transaction is in progress, a byte each, the
+                                      // I2C one is also written from the queue interrupt
+static uint16_t   startAt[BUS_COUNT]; // transaction start, Timer0 counts
+static uint16_t   beginAt[BUS_COUNT]; // operation start, Timer0 counts
+static uint16_t   padAt[BUS_COUNT];   // _delay_us total at the operation start
+
+
+
+/**
+ * @brief   Starts the counting windows. The start-up traffic is left out,
+ *          Timer0 periods are not counted while interrupts are off.
+ * @retval  none
+ */
+void Init_BusStat(void) {
+  for (uint8_t i = 0; i < BUS_COUNT; i++) {
+    BusStat_Reset(i);
+  }
+}
+
+
+/**
+ * @brief   Starts a transaction and its first operation. The transaction
+ *          length runs up to the last operation ended before it is closed.
+ *          A transaction in progress goes on, as on a repeated START.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Open(uint8_t bus) {
+  if (open[bus]) return;
+  BusStat_Begin(bus);
+  open[bus] = 1;
+  startAt[bus] = beginAt[bus];
+  stat[bus].trans++;
+}
+
+
+/**
+ * @brief   Ends a transaction.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Close(uint8_t bus) {
+  open[bus] = 0;
+}
+
+
+/**
+ * @brief   Starts a bus operation, the time up to BusStat_End() is busy.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Begin(uint8_t bus) {
+  beginAt[bus] = (uint16_t)Get_TimerCnt();
+  padAt[bus] = Get_DelayUs();
+}
+
+
+/**
+ * @brief   Ends a bus operation, adds its time and padding. A byte timed
+ *          bus gets its busy time from BusStat_ByteTime() instead.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_End(uint8_t bus) {
+  uint16_t now = (uint16_t)Get_TimerCnt();
+  bus_stat_t* s = &stat[bus];
+
+  if (!(BUS_BYTE_TIMED & _BV(bus))) {
+    s->busy += (uint32_t)(uint16_t)(now - beginAt[bus]) * BUS_US_PER_CNT;
+  }
+  s->pad += (uint16_t)(Get_DelayUs() - padAt[bus]);
+  if (open[bus]) {
+    uint16_t len = now - startAt[bus];
+    if (len > s->longest) s->longest = len;
+  }
+}
+
+
+/**
+ * @brief   Counts a byte sent or received.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Byte(uint8_t bus) {
+  stat[bus].bytes++;
+}
+
+
+/**
+ * @brief   Counts a byte sent or received on a byte timed bus.
+ * @param   bus counted bus
+ * @param   us wire time of the byte, us
+ * @retval  none
+ */
+void BusStat_ByteTime(uint8_t bus, uint8_t us) {
+  stat[bus].bytes++;
+  stat[bus].busy += us;
+}
+
+
+/**
+ * @brief   Counts a NACK or a missing presence pulse.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Fail(uint8_t bus) {
+  stat[bus].fails++;
+}
+
+
+/**
+ * @brief   Copies the counters of a bus.
+ * @param   bus counted bus
+ * @param   out the copy, its window is the time since the reset
+ * @retval  none
+ */
+void BusStat_Snapshot(uint8_t bus, bus_stat_t* out) {
+  IRQ_BLOCK {
+    *out = stat[bus];
+  }
+  out->window = Get_TimerCnt() - out->window;
+}
+
+
+/**
+ * @brief   Clears the counters of a bus and starts a new window.
+ * @param   bus counted bus
+ * @retval  none
+ */
+void BusStat_Reset(uint8_t bus) {
+  bus_stat_t* s = &stat[bus];
+
+  IRQ_BLOCK {
+    s->trans = 0;
+    s->bytes = 0;
+    s->fails = 0;
+    s->longest = 0;
+    s->busy = 0;
+    s->pad = 0;
+    s->window = Get_TimerCnt();
+  }
+}
+
@@ -38,6 +38,9 @@ static void Dd_WriteByte(uint8_t byte);
  * @retval none
  */
 static void Dd_Start(void) {
+  PTRACE_ARM(PTRACE_DD);
+  TRACE(TRACE_BUS_START, BUS_DD);
+  BusStat_Open(BUS_DD);
   CLK_H;
   DIO_H;
   _delay_us(2);
@@ -59,6 +62,9 @@ static void Dd_Stop(void) {
   _delay_us(2);
   DIO_H;
   _delay_us(2);
+  BusStat_End(BUS_DD);
+  BusStat_Close(BUS_DD);
+  TRACE(TRACE_BUS_STOP, BUS_DD);
 }
 
 
@@ -85,10 +91,14 @@ static void Dd_WriteByte(uint8_t byte) {
   CLK_L;
   _delay_us(5);
   DIO_IN;
+  BusStat_Byte(BUS_DD);
   if (!(DSPLPIN & _BV(DSPLDIO))) {
     CLK_H;
     _delay_us(2);
     CLK_L;
+  } else {
+    BusStat_Fail(BUS_DD);
+    PTRACE_FREEZE(PTRACE_SITE_DDNACK);
   }
   DIO_OUT;
 }
@@ -130,6 +140,7 @@ uint8_t Init_DigitalDisplay(void) {
  * @retval (uint8_t) the operation status
  */
 void DigitalDisplaySend(const uint8_t *buf, int8_t dot) {
+  BUS_LOCK(KM_OW);
   Dd_Start();
   Dd_WriteByte(0x40);
   Dd_Stop();
@@ -142,4 +153,5 @@ void DigitalDisplaySend(const uint8_t *buf, int8_t dot) {
     Dd_WriteByte(x);
   }
   Dd_Stop();
+  BUS_UNLOCK(KM_OW);
 }
@@ -10,27 +10,53 @@
 
 #include "display.h"
 
+/* --- Text ring marks of a clear and a line end, printable characters start at 0x20 --- */
+#define DSPL_CLEAR  0x01
+#define DSPL_FLUSH  0x02
+
 /* Private variables */
 static volatile uint8_t _DSPLREG_ = 0;
 static uint8_t diplPrintPos       = 0;
 volatile static uint8_t* _i2creg;
+static volatile uint8_t dsplText[DSPL_TEXT_SIZE];
+static volatile uint8_t dsplHead  = 0;
+static volatile uint8_t dsplTail  = 0;
+static volatile uint8_t dsplRun   = 0;  // the transaction is queued or on the bus
+static uint16_t dsplDrops         = 0;  // characters dropped on a full ring
+static uint8_t dsplStep           = 0;  // panel the character is on
+static i2c_xfer_t dsplXfer;
+static uint8_t dsplPanel[DSPL_PANELS];  // driver of each panel found at boot
+static uint8_t dsplPanels         = 0;
 
 
 /* Private function prototypes */
-static uint16_t Calc_BufferLength(const char*);
+static void Dspl_Push(uint8_t);
+static void Dspl_Next(i2c_xfer_t*);
+static void Dspl_Done(i2c_xfer_t*);
+static uint8_t Dspl_Put(uint8_t, i2c_xfer_t*, uint8_t);
 
 #if defined(DSPL_WH1602)
-  static void WH1602_I2C_Init(void);
-  static void WH1602_WriteChar(uint8_t);
-  static void WH1602_WriteCommand(uint8_t, uint16_t);
+  static uint8_t wh1602Buf[4];
+  static uint8_t wh1602Step = 0;
+  static uint8_t wh1602Sync = 0;  // init commands left to bring the nibbles back in step
+
+  static uint8_t WH1602_I2C_Init(void);
+  static uint8_t WH1602_WriteCommand(uint8_t, uint16_t);
+  static uint8_t WH1602_Next(i2c_xfer_t*, uint8_t);
+  static uint8_t WH1602_Clear(i2c_xfer_t*);
+  static void WH1602_Sync(i2c_xfer_t*);
+  static void WH1602_Fill(i2c_xfer_t*, uint8_t, uint8_t, uint16_t);
+  static void WH1602_Nibbles(uint8_t*, uint8_t, uint8_t);
   // static void WH1602_I2C_ReadByte(uint8_t);
   // static void WH1602_I2C_Read(uint16_t, uint8_t*);
 #endif
 
 #if defined(DSPL_SSD1315)
   static uint8_t SSD1315_I2C_Init(void);
-  static uint8_t SSD1315_WriteCommand(uint8_t);
-  static uint8_t SSD1315_WriteDataByte(uint8_t);
+  static uint8_t SSD1315_Next(i2c_xfer_t*, uint8_t);
+  static uint8_t SSD1315_Flush(i2c_xfer_t*);
+  static uint8_t SSD1315_Clear(i2c_xfer_t*);
+  static void SSD1315_Advance(uint8_t*);
 #endif
 
 
@@ -86,118 +112,194 @@ static uint16_t Calc_BufferLength(const char*);
     0x22, 0x00, 0x07  // set page address from 0 to 7
   };
 
+#if defined(FONT_DOT_10X14)
   const static uint8_t ssd1315InitCurPosParams[8] PROGMEM = {
     0x20, 0x01, 
     0x21, 0x00, 0x0b, 
     0x22, 0x05, 0x06
   };
+#else
+  const static uint8_t ssd1315InitCurPosParams[8] PROGMEM = {
+    0x20, 0x00, 
+    0x21, 0x00, 0x05, 
+    0x22, 0x06, 0x06
+  };
+#endif
 
-  // const static uint8_t ssd1315InitCurPosParams[8] PROGMEM = {
-  //   0x20, 0x00, 
-  //   0x21, 0x00, 0x05, 
-  //   0x22, 0x06, 0x06
-  // };
+  /* --- Last column a whole glyph reaches, the rest of a row stays blank --- */
+  #define SSD1315_ROW_END   ((128 / _SSD1315_GLYPHW_) * _SSD1315_GLYPHW_ - 1)
 
   static uint8_t ssd1315CurrentCurPosParams[8];
+  static uint8_t ssd1315Step = 0;
 
 #endif
 
 
-/**
- * @brief  Writes/Sends a command to WH1602A display
- * @param  buf: pointer to the character/text buffer
- * @retval The buffer length 
- */
-static uint16_t Calc_BufferLength(const char* buf) {
-  uint16_t len = 0;
-  while(*buf) {
-    len++;
-    buf++;
-    if (*buf == 0x0a) break;
-  }
-  return len;
-}
+/* --- Panel drivers in the probe and mirror order --- */
+static const dspl_drv_t dsplDrivers[] PROGMEM = {
+#if defined(DSPL_WH1602)
+  {_1602A_ADDR_,   WH1602_I2C_Init,  WH1602_Next,  NULL,          WH1602_Clear},
+#endif
+#if defined(DSPL_SSD1315)
+  {_SSD1315_ADDR_, SSD1315_I2C_Init, SSD1315_Next, SSD1315_Flush, SSD1315_Clear},
+#endif
+};
+
+#define DSPL_DRIVERS  (sizeof(dsplDrivers) / sizeof(dspl_drv_t))
 
 
 /**
- * @brief  Writes/Sends character to the given display
+ * @brief  Writes/Sends character to the given display. The character is
+ *         queued, the I2C interrupt sends it.
  * @param  ch: character to write
  * @param  stream: Standard stream
  * @retval (int) status
  */
 int putc_dspl(char ch, FILE *stream){
   // if (ch == '\n') putc_dspl('\r', stream);
-#if defined(DSPL_WH1602)
-  I2C_WRITE;
+  BUS_LOCK(KM_I2C);
   if ((FLAG_CHECK(_DSPLREG_, _0DCF_)) || (FLAG_CHECK(_DSPLREG_, _0ACF_))) {
     FLAG_CLR(_DSPLREG_, _0DCF_);
     FLAG_CLR(_DSPLREG_, _0ACF_);
-
-    I2C_Start();
-    I2C_SendAddress(_1602A_ADDR_);
-    WH1602_WriteCommand(_1602A_CLRDSLP_, 1640);
-    WH1602_WriteCommand(_1602A_1LS_, 40);
-    I2C_Stop();
-    diplPrintPos = 0;
+    Dspl_Push(DSPL_CLEAR);
   }
   if ((ch != 0x0a) && (ch != 0x0d)) {
-    I2C_Start();
-    I2C_SendAddress(_1602A_ADDR_);
-    if (diplPrintPos > 15) {
-      WH1602_WriteCommand(_1602A_2LS_, 40);
-      diplPrintPos = 0;
-    }
-    WH1602_WriteChar(ch);
-    I2C_Stop();
-    diplPrintPos++;
+    Dspl_Push((uint8_t)ch);
+  } else {
+    Dspl_Push(DSPL_FLUSH);
   }
-#endif /* DSPL_WH1602 */
 
-#if defined(DSPL_SSD1315)
+  if (ch == 0x0a) FLAG_SET(_DSPLREG_, _0DCF_);
+  if (ch == 0x0d) FLAG_SET(_DSPLREG_, _0ACF_);
 
-  if ((FLAG_CHECK(_DSPLREG_, _0DCF_)) || (FLAG_CHECK(_DSPLREG_, _0ACF_))) {
-    FLAG_CLR(_DSPLREG_, _0DCF_);
-    FLAG_CLR(_DSPLREG_, _0ACF_);
-    for (uint8_t i = 0; i < sizeof(ssd1315InitCurPosParams); i++) {
-      ssd1315CurrentCurPosParams[i] = pgm_read_byte(&ssd1315InitCurPosParams[i]);
+  BUS_UNLOCK(KM_I2C);
+  return 0;
+}
+
+
+/**
+ * @brief  Returns the characters dropped on a full text ring.
+ * @retval (uint16_t) dropped characters, saturated
+ */
+uint16_t Dspl_Drops(void) {
+  return dsplDrops;
+}
+
+
+/**
+ * @brief  Puts a character or a clear into the text ring and starts the
+ *         transaction chain if it is idle. The caller never waits on the
+ *         bus, a character that finds the ring full is dropped and counted.
+ * @param  c: character, DSPL_CLEAR or DSPL_FLUSH
+ * @retval None
+ */
+static void Dspl_Push(uint8_t c) {
+  IRQ_BLOCK {
+    uint8_t next = (dsplHead + 1) & (DSPL_TEXT_SIZE - 1);
+    if (next == dsplTail) {
+      if (dsplDrops != UINT16_MAX) dsplDrops++;
+    } else {
+      dsplText[dsplHead] = c;
+      dsplHead = next;
+      if (!dsplRun) {
+        dsplRun = 1;
+        Dspl_Next(&dsplXfer);
+      }
     }
   }
-  if ((ch != 0x0a) && (ch != 0x0d)) {
-    SSD1315_WriteBuf(font_dot_10x14[(((uint8_t)ch) - 32)], sizeof(font_dot_10x14_t), ssd1315CurrentCurPosParams);
+}
+
+
+/**
+ * @brief  Called back by the I2C interrupt when a transaction is done. A
+ *         WH1602 write cut short may have left half a byte in the 4-bit
+ *         bus, and an unplugged one comes back in the 8-bit mode. The next
+ *         write resends the bus setup first.
+ * @param  x: the display transaction
+ * @retval None
+ */
+static void Dspl_Done(i2c_xfer_t* x) {
+#if defined(DSPL_WH1602)
+  if ((x->addr == _1602A_ADDR_) && (x->status != I2C_XS_DONE) && (x->status != I2C_XS_BACKOFF)) {
+    wh1602Sync = _1602A_SYNC_STEPS_;
   }
+#endif
+  Dspl_Next(x);
+}
 
-#endif /* DSPL_SSD1315 */
 
-  if (ch == 0x0a) FLAG_SET(_DSPLREG_, _0DCF_);
-  if (ch == 0x0d) FLAG_SET(_DSPLREG_, _0ACF_);
+/**
+ * @brief  Sets up and queues the next transaction of the text ring, called
+ *         back by Dspl_Done() when the previous one is done. Each
+ *         character goes to every panel in turn.
+ * @param  x: the display transaction
+ * @retval None
+ */
+static void Dspl_Next(i2c_xfer_t* x) {
+  while (dsplTail != dsplHead) {
+    uint8_t c = dsplText[dsplTail];
+    for (; dsplStep < dsplPanels; dsplStep++) {
+      if (Dspl_Put(dsplPanel[dsplStep], x, c)) {
+        /* --- A full queue, the next character restarts the chain --- */
+        if (I2C_Submit(x)) dsplRun = 0;
+        return;
+      }
+    }
+    dsplStep = 0;
+    dsplTail = (dsplTail + 1) & (DSPL_TEXT_SIZE - 1);
+  }
+  dsplRun = 0;
+}
 
-  return 0;
+
+/**
+ * @brief  Sets up the next transaction of a character, a clear or a line
+ *         end through the panel driver.
+ * @param  drv: driver index
+ * @param  x: the display transaction
+ * @param  c: character, DSPL_CLEAR or DSPL_FLUSH
+ * @retval (uint8_t) 1 - queue it, 0 - the character is done
+ */
+static uint8_t Dspl_Put(uint8_t drv, i2c_xfer_t* x, uint8_t c) {
+  const dspl_drv_t* d = &dsplDrivers[drv];
+
+  if (c == DSPL_CLEAR) {
+    uint8_t (*clear)(i2c_xfer_t*) = (uint8_t (*)(i2c_xfer_t*))pgm_read_ptr(&d->clear);
+    return clear(x);
+  }
+  if (c == DSPL_FLUSH) {
+    uint8_t (*flush)(i2c_xfer_t*) = (uint8_t (*)(i2c_xfer_t*))pgm_read_ptr(&d->flush);
+    return flush ? flush(x) : 0;
+  }
+  uint8_t (*put)(i2c_xfer_t*, uint8_t) = (uint8_t (*)(i2c_xfer_t*, uint8_t))pgm_read_ptr(&d->putc);
+  return put(x, c);
 }
 
 
 
 /**
- * @brief  Initializes display
- * @retval (uint8_t) status of operation
+ * @brief  Initializes display: scans the bus and sets up each panel of a
+ *         built-in driver that answers, up to DSPL_PANELS of them.
+ * @retval (uint8_t) status of operation, 1 - no panel
  */
 uint8_t Init_Display(void) {
   _i2creg = Get_I2CREG();
+  dsplXfer.done = Dspl_Done;
 
-#if defined(DSPL_WH1602)
-  WH1602_I2C_Init();
-  return 0;
-#endif
-#if defined(DSPL_SSD1315)
-  if (SSD1315_I2C_Init()) {
-    FLAG_SET(*_i2creg, _I2C_BERF_);
-    I2C_Stop();
-    return 1;
-  }
-  for (uint8_t i = 0; i < sizeof(ssd1315InitCurPosParams); i++) {
-    ssd1315CurrentCurPosParams[i] = pgm_read_byte(&ssd1315InitCurPosParams[i]);
+  /* Initial delay according the panel documentation, the scan follows it */
+  _delay_us(15000);
+  I2C_Scan();
+
+  dsplPanels = 0;
+  for (uint8_t i = 0; (i < DSPL_DRIVERS) && (dsplPanels < DSPL_PANELS); i++) {
+    const dspl_drv_t* d = &dsplDrivers[i];
+    uint8_t (*init)(void) = (uint8_t (*)(void))pgm_read_ptr(&d->init);
+
+    if (!I2C_Found(pgm_read_byte(&d->addr))) continue;
+    if (init()) continue;
+    dsplPanel[dsplPanels++] = i;
   }
-  return 0;
-#endif
+  return dsplPanels ? 0 : 1;
 }
 
 
@@ -207,125 +309,151 @@ uint8_t Init_Display(void) {
 #if defined(DSPL_SSD1315)
 
 /**
- * @brief  Initializes WH1602A display
+ * @brief  Initializes SSD1315 display
  * @retval (uint8_t) status of operation
  */
 static uint8_t SSD1315_I2C_Init(void) {
+  static const uint8_t zero = 0x00;
  
-  /* Initial delay according ssd1315 documentation */
-  _delay_us(15000);
-  I2C_WRITE;
+  SSD1315_Clear(NULL);
+  I2C_SetSpeed(_SSD1315_SPEED_);
 
   /* --- Initialization commands --- */
-  for (uint8_t i = 0; i < sizeof(ssd1315InitParams); i++) {
-    if (SSD1315_WriteCommand(pgm_read_byte(&ssd1315InitParams[i]))) return 1;
-  }
-
-    /* --- Clear display --- */
-  for (uint8_t i = 0; i < sizeof(ssd1315ClrDspl); i++) {
-    if (SSD1315_WriteCommand(pgm_read_byte(&ssd1315ClrDspl[i]))) return 1;
-  }
+  if (I2C_WriteCtrl(_SSD1315_ADDR_, _SSD1315_CMD_, ssd1315InitParams, sizeof(ssd1315InitParams), I2C_XF_PGM)) return 1;
 
-  I2C_Start();
-  _delay_us(1);
-  /* --- Control ACK on sending address --- */
-  I2C_SendAddress(_SSD1315_ADDR_);
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-  /* --- Send control byte --- */
-  if (SSD1315_WriteDataByte((uint8_t)(_BV(_SSD1315_DC_)&~_BV(_SSD1315_Co_)))) return 1;
-
-  for (uint8_t i = 0; i < 8; i++) {
-    for (uint8_t y = 0; y < 128; y++) {
-      if (SSD1315_WriteDataByte(0x00)) return 1;
-    }
-  }
-  I2C_Stop();  
-  return 0;
+  /* --- Clear display, the whole RAM window in one burst --- */
+  if (I2C_WriteCtrl(_SSD1315_ADDR_, _SSD1315_CMD_, ssd1315ClrDspl, sizeof(ssd1315ClrDspl), I2C_XF_PGM)) return 1;
+  return I2C_WriteCtrl(_SSD1315_ADDR_, _SSD1315_DATA_, &zero, 8 * 128, I2C_XF_FILL);
 }
 
 
 /**
- * @brief  Writes/Sends a command to SSD1315 display
- * @param  cmd: ssd1315 command
- * @retval (uint8_t) status of operation
+ * @brief  Moves the cursor window on by a glyph, the next line up follows
+ *         the last column.
+ * @param  pos: pointer to the cursor position
+ * @retval None
  */
-static uint8_t SSD1315_WriteCommand(uint8_t cmd) {
-  I2C_Start();
-  _delay_us(1);
-
-  /* --- Control ACK on sending address --- */
-  I2C_SendAddress(_SSD1315_ADDR_);
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-  
-  /* --- Send control byte --- */
-  I2C_SendByte((uint8_t)(~_BV(_SSD1315_Co_)&~_BV(_SSD1315_DC_)));
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-  
-  /* --- Send data byte --- */
-  I2C_SendByte(cmd);
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-
-  I2C_Stop();
-  return 0;
+static void SSD1315_Advance(uint8_t* pos) {
+  if (((pos[4] + _SSD1315_GLYPHW_) & 0x7f) < pos[3]) {
+    pos[3] = 0x00;
+    pos[4] = _SSD1315_GLYPHW_ - 1;
+    pos[6] = (pos[6] - _SSD1315_GLYPHH_) & 0x07;
+    pos[7] = (pos[7] - _SSD1315_GLYPHH_) & 0x07;
+  } else {
+    pos[3] = pos[4] + 1;
+    pos[4] = pos[4] + _SSD1315_GLYPHW_;
+  }
 }
 
 
 /**
- * @brief  Writes/Sends a data to SSD1315 display
- * @param  data: ssd1315 data byte
- * @retval (uint8_t) status of operation
+ * @brief  Sets up the next transaction of a line end: blanks the rest of
+ *         the rows from the cursor on, a window and a fill for each, so a
+ *         shorter line leaves nothing of the one before. A clear only
+ *         takes the cursor home.
+ * @param  x: the display transaction
+ * @retval (uint8_t) 1 - queue it, 0 - the line end is done
  */
-static uint8_t SSD1315_WriteDataByte(uint8_t data) {
-  /* --- Send data byte --- */
-  I2C_SendByte(data);
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-  
+static uint8_t SSD1315_Flush(i2c_xfer_t* x) {
+  static const uint8_t zero = 0x00;
+  uint8_t* pos = ssd1315CurrentCurPosParams;
+  x->addr = _SSD1315_ADDR_;
+  x->speed = _SSD1315_SPEED_;
+  x->rdLen = 0;
+  x->gap = 0;
+
+  switch (ssd1315Step) {
+    case 0:
+      if (!I2C_Ready(_SSD1315_ADDR_)) break;
+      pos[4] = SSD1315_ROW_END;
+      x->flags = I2C_XF_CTRL;
+      x->ctrl = _SSD1315_CMD_;
+      x->wr = pos;
+      x->wrLen = sizeof(ssd1315CurrentCurPosParams);
+      ssd1315Step = 1;
+      return 1;
+
+    case 1:
+      x->flags = I2C_XF_CTRL|I2C_XF_FILL;
+      x->ctrl = _SSD1315_DATA_;
+      x->wr = &zero;
+      x->wrLen = (SSD1315_ROW_END + 1 - pos[3]) * _SSD1315_GLYPHH_;
+      /* --- The rows run down to page 0, the next one up wraps --- */
+      if (((pos[6] - _SSD1315_GLYPHH_) & 0x07) > pos[6]) {
+        ssd1315Step = 2;
+      } else {
+        pos[3] = 0x00;
+        pos[6] -= _SSD1315_GLYPHH_;
+        pos[7] -= _SSD1315_GLYPHH_;
+        ssd1315Step = 0;
+      }
+      return 1;
+
+    default:
+      break;
+  }
+  ssd1315Step = 0;
   return 0;
 }
 
 
 /**
- * @brief  Writes/Sends a text buffer to SSD1315 display
- * @param  buf: pointer to the character/text buffer
- * @param  len: buffer length
- * @param  pos: pointer to the cursor position
- * @retval (uint8_t) status of operation
+ * @brief  Takes the cursor home, a clear needs no transaction.
+ * @param  x: the display transaction, not used
+ * @retval (uint8_t) 0 - the clear is done
  */
-uint8_t SSD1315_WriteBuf(const uint8_t* buf, uint16_t len, uint8_t* pos) {
-  I2C_WRITE;
-
-  /* --- Set cursor position --- */
-  for (uint8_t i = 0; i < 8; i++) {
-    if (SSD1315_WriteCommand(pos[i])) return 1;
-  }
-  
-  if (((pos[4] + 12) & 0x7f) < pos[3]) {
-    pos[3] = 0x00;
-    pos[4] = 0x0b;
-    pos[6] = (pos[6] - 2) & 0x07;
-    pos[7] = (pos[7] - 2) & 0x07;
-  } else {
-    pos[3] = pos[4] + 1;
-    pos[4] = pos[4] + 12;
+static uint8_t SSD1315_Clear(i2c_xfer_t* x) {
+  (void)x;
+  for (uint8_t i = 0; i < sizeof(ssd1315InitCurPosParams); i++) {
+    ssd1315CurrentCurPosParams[i] = pgm_read_byte(&ssd1315InitCurPosParams[i]);
   }
+  return 0;
+}
 
-  /* --- Write the buffer --- */
-  I2C_Start();
-  _delay_us(1);
-
-  /* --- Control ACK on sending address --- */
-  I2C_SendAddress(_SSD1315_ADDR_);
-  if (!FLAG_CHECK(*_i2creg, _I2C_ACKF_)) return 1;
-
-  /* --- Send control byte --- */
-  if (SSD1315_WriteDataByte((uint8_t)(_BV(_SSD1315_DC_)&~_BV(_SSD1315_Co_)))) return 1;
 
-  /* --- Send buffer data --- */
-  for (uint8_t i = 0; i < len; i++) {
-    if (SSD1315_WriteDataByte(pgm_read_byte(&buf[i]))) return 1;
+/**
+ * @brief  Sets up the next transaction of a character: the cursor position
+ *         commands, then the glyph straight from flash. A display backing
+ *         off is skipped.
+ * @param  x: the display transaction
+ * @param  c: character
+ * @retval (uint8_t) 1 - queue it, 0 - the character is done
+ */
+static uint8_t SSD1315_Next(i2c_xfer_t* x, uint8_t c) {
+  uint8_t* pos = ssd1315CurrentCurPosParams;
+  x->addr = _SSD1315_ADDR_;
+  x->speed = _SSD1315_SPEED_;
+  x->rdLen = 0;
+  x->gap = 0;
+
+  switch (ssd1315Step++) {
+    case 0:
+      if (!I2C_Ready(_SSD1315_ADDR_)) {
+        /* --- A display backing off costs no bus time, the cursor runs on --- */
+        SSD1315_Advance(pos);
+        ssd1315Step = 0;
+        return 0;
+      }
+      /* --- Co = 0, the rest of the transaction is commands --- */
+      x->flags = I2C_XF_CTRL;
+      x->ctrl = _SSD1315_CMD_;
+      x->wr = pos;
+      x->wrLen = sizeof(ssd1315CurrentCurPosParams);
+      return 1;
+
+    case 1:
+      /* --- The position is sent, move it on for the next glyph --- */
+      SSD1315_Advance(pos);
+      x->flags = I2C_XF_CTRL|I2C_XF_PGM;
+      x->ctrl = _SSD1315_DATA_;
+      x->wr = _SSD1315_GLYPH_(c);
+      x->wrLen = _SSD1315_GLYPHLEN_;
+      return 1;
+
+    default:
+      ssd1315Step = 0;
+      return 0;
   }
-  I2C_Stop();
-  return 0;
 }
 
 
@@ -339,85 +467,162 @@ uint8_t SSD1315_WriteBuf(const uint8_t* buf, uint16_t len, uint8_t* pos) {
 
 /**
  * @brief  Initializes WH1602A display
- * @retval None
+ * @retval (uint8_t) status of operation
  */
-void WH1602_I2C_Init(void) {
- 
-  /* Initial delay according 1602a documentation */
-  _delay_us(15000);
+static uint8_t WH1602_I2C_Init(void) {
  
   /* Initial parameter-delay pairs */
-  I2C_WRITE;
-  I2C_Start();
-  I2C_SendAddress(_1602A_ADDR_);
+  I2C_SetSpeed(_1602A_SPEED_);
   for(uint8_t i = 0; i < sizeof(wh1602InitParams); i++) {
-    I2C_SendByte(_WR1NCMD(pgm_read_byte(&wh1602InitParams[i])));
-    I2C_SendByte(_WR2NCMD(pgm_read_byte(&wh1602InitParams[i])));
-    I2C_SendByte(_WR1NCMD(pgm_read_byte(&wh1602InitParams[i]) << 4));
-    I2C_SendByte(_WR2NCMD(pgm_read_byte(&wh1602InitParams[i]) << 4));
-    _delay_us(pgm_read_word(&wh1602InitDelays[i]));
+    if (WH1602_WriteCommand(pgm_read_byte(&wh1602InitParams[i]), pgm_read_word(&wh1602InitDelays[i]))) return 1;
   }
-  I2C_Stop();
+  return 0;
 }
 
 
 /**
- * @brief  Writes/Sends a character symbol to WH1602A display
- * @param  ch: ACSII character
- * @retval None
+ * @brief  Writes/Sends a command to WH1602A display
+ * @param  cmd: 1602a command
+ * @param  delay: command delay according documentation
+ * @retval (uint8_t) status of operation
  */
-void WH1602_WriteChar(uint8_t ch) {
-  I2C_WRITE;
-  I2C_SendByte(_WR1NCHAR(ch));
-  I2C_SendByte(_WR2NCHAR(ch));
-  I2C_SendByte(_WR1NCHAR(ch << 4));
-  I2C_SendByte(_WR2NCHAR(ch << 4));
-  _delay_us(40);
+uint8_t WH1602_WriteCommand(uint8_t cmd, uint16_t delay) {  
+  uint8_t buf[4];
+  uint8_t status;
+
+  WH1602_Nibbles(buf, cmd, 0);
+  status = I2C_Write(_1602A_ADDR_, buf, sizeof(buf), 0);
+  _delay_us(delay);
+  return status;
 }
 
 
 /**
- * @brief  Writes/Sends a command to WH1602A display
- * @param  cmd: 1602a command
- * @param  delay: command delay according documentation
+ * @brief  Sets up the next transaction of a character: the line command
+ *         when one is due, then the character. A display backing off is
+ *         skipped, one that lost a write is set up again first.
+ * @param  x: the display transaction
+ * @param  c: character
+ * @retval (uint8_t) 1 - queue it, 0 - the character is done
+ */
+static uint8_t WH1602_Next(i2c_xfer_t* x, uint8_t c) {
+  switch (wh1602Step++) {
+    case 0:
+      if (!I2C_Ready(_1602A_ADDR_)) {
+        /* --- A display backing off costs no bus time, its place in the text runs on --- */
+        diplPrintPos = (diplPrintPos > 15) ? 1 : diplPrintPos + 1;
+        break;
+      }
+      if (wh1602Sync) {
+        WH1602_Sync(x);
+        return 1;
+      }
+      if (diplPrintPos > 15) {
+        WH1602_Fill(x, _1602A_2LS_, 0, 40);
+        diplPrintPos = 0;
+        return 1;
+      }
+      wh1602Step++;
+      /* fall through */
+    case 1:
+      WH1602_Fill(x, c, 1, 40);
+      diplPrintPos++;
+      return 1;
+
+    default:
+      break;
+  }
+  wh1602Step = 0;
+  return 0;
+}
+
+
+/**
+ * @brief  Sets up the next transaction of a clear: the clear command, then
+ *         the first line command.
+ * @param  x: the display transaction
+ * @retval (uint8_t) 1 - queue it, 0 - the clear is done
+ */
+static uint8_t WH1602_Clear(i2c_xfer_t* x) {
+  switch (wh1602Step++) {
+    case 0:
+      diplPrintPos = 0;
+      if (!I2C_Ready(_1602A_ADDR_)) break;
+      if (wh1602Sync) {
+        WH1602_Sync(x);
+        return 1;
+      }
+      WH1602_Fill(x, _1602A_CLRDSLP_, 0, 1640);
+      return 1;
+
+    case 1:
+      WH1602_Fill(x, _1602A_1LS_, 0, 40);
+      return 1;
+
+    default:
+      break;
+  }
+  wh1602Step = 0;
+  return 0;
+}
+
+
+/**
+ * @brief  Puts the next command of the 8-bit setup, back to 4 bits and
+ *         the display on, into the transaction. The character or the
+ *         clear waits for the whole setup.
+ * @param  x: the display transaction
  * @retval None
  */
-void WH1602_WriteCommand(uint8_t cmd, uint16_t delay) {  
-  I2C_WRITE;
-  I2C_SendByte(_WR1NCMD(cmd));
-  I2C_SendByte(_WR2NCMD(cmd));
-  I2C_SendByte(_WR1NCMD(cmd << 4));
-  I2C_SendByte(_WR2NCMD(cmd << 4));
-  _delay_us(delay);
+static void WH1602_Sync(i2c_xfer_t* x) {
+  uint8_t i = _1602A_SYNC_STEPS_ - wh1602Sync--;
+
+  WH1602_Fill(x, pgm_read_byte(&wh1602InitParams[i]), 0, pgm_read_word(&wh1602InitDelays[i]));
+  wh1602Step = 0;
 }
 
 
 /**
- * @brief  Writes/Sends a text buffer to WH1602A display
- * @param  line: 1602a display line [1,2]
- * @param  extraCmd: extra 1602a command, e.g. clear display
- * @param  buf: pointer to the character/text buffer
+ * @brief  Puts a command or a character into the transaction, as the two
+ *         nibble writes with E pulses.
+ * @param  x: the display transaction
+ * @param  val: command or character
+ * @param  rs: 1 - character, 0 - command
+ * @param  delay: execution time, the bus stays idle for it
  * @retval None
  */
-void WH1602_Write(uint8_t line, uint8_t extraCmd, const char* buf) {
-  
-  I2C_WRITE;
-  I2C_Start();
-  I2C_SendAddress(_1602A_ADDR_);
-
-  if (extraCmd) {
-    WH1602_WriteCommand(extraCmd, 1640);
-  }
+static void WH1602_Fill(i2c_xfer_t* x, uint8_t val, uint8_t rs, uint16_t delay) {
+  WH1602_Nibbles(wh1602Buf, val, rs);
+  x->addr = _1602A_ADDR_;
+  x->speed = _1602A_SPEED_;
+  x->flags = 0;
+  x->wr = wh1602Buf;
+  x->wrLen = sizeof(wh1602Buf);
+  x->rdLen = 0;
+  x->gap = I2C_GAP(delay);
+}
+
 
-  uint8_t dsplAddr = (line == 2) ? _1602A_2LS_ : _1602A_1LS_;
-  WH1602_WriteCommand(dsplAddr, 40);
-  
-  uint16_t len = Calc_BufferLength(buf);
-  
-  for(uint16_t i = 0 ; i < len ; i++) {
-    WH1602_WriteChar(*(buf++));
+/**
+ * @brief  Splits a command or a character into the two nibble writes with
+ *         E pulses.
+ * @param  buf: four bytes
+ * @param  val: command or character
+ * @param  rs: 1 - character, 0 - command
+ * @retval None
+ */
+static void WH1602_Nibbles(uint8_t* buf, uint8_t val, uint8_t rs) {
+  if (rs) {
+    buf[0] = _WR1NCHAR(val);
+    buf[1] = _WR2NCHAR(val);
+    buf[2] = _WR1NCHAR(val << 4);
+    buf[3] = _WR2NCHAR(val << 4);
+  } else {
+    buf[0] = _WR1NCMD(val);
+    buf[1] = _WR2NCMD(val);
+    buf[2] = _WR1NCMD(val << 4);
+    buf[3] = _WR2NCMD(val << 4);
   }
-  I2C_Stop();
 }
 
 
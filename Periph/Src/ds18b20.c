@@ -11,6 +11,10 @@
 
 /* Private variables */
 static volatile uint8_t  _DSREG_  = 0;
+static uint8_t pps;
+
+/* Private function definitions */
+static uint8_t DS18B20_Converted(void);
 
 
 /**
@@ -29,7 +33,10 @@ uint8_t DS18B20_ReadScrachpad(uint8_t* addr, uint8_t* buf) {
     buf[i] = OneWire_ReadByte();
     crc = OneWire_CRC(crc, buf[i]);
   }
-  if (crc) return 1;
+  if (crc) {
+    PTRACE_FREEZE(PTRACE_SITE_PADCRC);
+    return 1;
+  }
   
   return 0;
 }
@@ -55,67 +62,103 @@ uint8_t DS18B20_WriteScratchpad(uint8_t* addr, uint8_t* buf) {
 
 /**
  * @brief   Writes the convert temperature command to the given device.
+ *          Coroutine, waits for the conversion without holding the CPU.
+ *          The OneWire bus mutex is let go over the wait and is held
+ *          again on return.
+ * @param   pt a pointer to the coroutine state
  * @param   addr a pointer to address of the given device
- * @retval  (uint8_t) status of operation
+ * @retval  (uint8_t) status of operation, PT_WAITING while converting
  */
-uint8_t DS18B20_ConvertTemperature(uint8_t* addr) {
-  if (OneWire_MatchROM(addr)) return 1;
-  uint8_t pps = OneWire_ReadPowerSupply(addr);
+uint8_t DS18B20_ConvertTemperature(pt_t* pt, uint8_t* addr) {
+  PT_BEGIN(pt);
 
-  if (OneWire_MatchROM(addr)) return 1;
+  if (OneWire_MatchROM(addr)) PT_EXIT(pt, 1);
+  pps = OneWire_ReadPowerSupply(addr);
+
+  if (OneWire_MatchROM(addr)) PT_EXIT(pt, 1);
   OneWire_WriteByte(ConvertT);
   
+  FLAG_SET(_DSREG_, _DSDF_);
+  TRACE(TRACE_CONV_BEGIN, 0);
+  /* --- The strong pull-up is due within 10 us, before a yield can come --- */
+  if (pps) OW_SP_UP;
+  BUS_UNLOCK(KM_OW);
   if (pps) {
-    OW_SP_UP;
-    _delay_ms(750, &_DSREG_, _DSDF_);
+    PT_AWAIT_MS(pt, 750);
+    BUS_LOCK(KM_OW);
     OW_SP_DOWN;
   } else {
     /* TDOD implement timeout, handle independently */
-    while(!OneWire_ReadBit());
+    PT_AWAIT_UNTIL(pt, DS18B20_Converted());
   }
+  FLAG_CLR(_DSREG_, _DSDF_);
+  TRACE(TRACE_CONV_END, 0);
   
+  PT_END(pt);
+}
+
+
+/**
+ * @brief   Polls a conversion with one read slot, the bus is taken for
+ *          the slot only and is kept once the conversion is done.
+ * @retval  (uint8_t) 1 - the conversion is done, 0 - still converting
+ */
+static uint8_t DS18B20_Converted(void) {
+  BUS_LOCK(KM_OW);
+  if (OneWire_ReadBit()) return 1;
+  BUS_UNLOCK(KM_OW);
   return 0;
 }
 
 
 /**
  * @brief   Copies the scratchpad data of the given device.
+ *          Coroutine, waits for the copy without holding the CPU.
+ * @param   pt a pointer to the coroutine state
  * @param   addr a pointer to address of the given device
- * @retval  (uint8_t) status of operation
+ * @retval  (uint8_t) status of operation, PT_WAITING while copying
  */
-uint8_t DS18B20_CopyScratchpad(uint8_t* addr) {
-  if (OneWire_MatchROM(addr)) return 1;
-  uint8_t pps = OneWire_ReadPowerSupply(addr);
+uint8_t DS18B20_CopyScratchpad(pt_t* pt, uint8_t* addr) {
+  PT_BEGIN(pt);
 
-  if (OneWire_MatchROM(addr)) return 1;
+  if (OneWire_MatchROM(addr)) PT_EXIT(pt, 1);
+  pps = OneWire_ReadPowerSupply(addr);
+
+  if (OneWire_MatchROM(addr)) PT_EXIT(pt, 1);
   OneWire_WriteByte(CopyScratchpad);
 
+  FLAG_SET(_DSREG_, _DSDF_);
   if (pps) {
     OW_SP_UP;
-    _delay_ms(10, &_DSREG_, _DSDF_);
+    PT_AWAIT_MS(pt, 10);
     OW_SP_DOWN;
   } else {
     /* TDOD implement timeout, handle independently */
-    while(!OneWire_ReadBit());
+    PT_AWAIT_UNTIL(pt, OneWire_ReadBit());
   }
+  FLAG_CLR(_DSREG_, _DSDF_);
   
-  return 0;
+  PT_END(pt);
 }
 
 
 /**
  * @brief   Recalls the EEPROM data of the given device.
+ *          Coroutine, polls for the recall completion once a tick.
+ * @param   pt a pointer to the coroutine state
  * @param   addr a pointer to address of the given device
- * @retval  (uint8_t) status of operation
+ * @retval  (uint8_t) status of operation, PT_WAITING while recalling
  */
-uint8_t DS18B20_RecallEeprom(uint8_t* addr) {
-  if (OneWire_MatchROM(addr)) return 1;
+uint8_t DS18B20_RecallEeprom(pt_t* pt, uint8_t* addr) {
+  PT_BEGIN(pt);
+
+  if (OneWire_MatchROM(addr)) PT_EXIT(pt, 1);
   OneWire_WriteByte(RecallEeprom);
   
   /* TDOD implement timeout, handle independently */
-  while(!OneWire_ReadBit());
+  PT_AWAIT_UNTIL(pt, OneWire_ReadBit());
   
-  return 0;
+  PT_END(pt);
 }
 
 
@@ -21,12 +21,13 @@ uint8_t EEPROM_WriteBuffer(uint16_t addr, uint8_t* buf, uint16_t len) {
   while (len--) {
     /* TODO implement timeout with error exit */
     while (EECR & _BV(EEPE));
-    cli();
-    EEAR = addr;
-    EEDR = *buf;
-    EECR |= _BV(EEMPE);
-    EECR |= _BV(EEPE);
-    sei();
+    /* --- EEPE must follow EEMPE within four cycles --- */
+    IRQ_BLOCK {
+      EEAR = addr;
+      EEDR = *buf;
+      EECR |= _BV(EEMPE);
+      EECR |= _BV(EEPE);
+    }
     addr++;
     buf++;
   }
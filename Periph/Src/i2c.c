@@ -10,11 +10,59 @@
 
 #include "i2c.h"
 
+/* Queue steps */
+#define I2C_ST_START    0 // START and the address
+#define I2C_ST_WRITE    1 // ctrl and write bytes
+#define I2C_ST_RESTART  2 // repeated START and the read address
+#define I2C_ST_READ     3 // read bytes
+
+/* --- Delay loops of a microsecond in the clock-stretch wait --- */
+#define I2C_US_LOOPS    ((F_CPU / 1000000UL) / I2C_LOOP_CYC)
+
+
+/* Failure record of a device */
+typedef struct {
+  uint8_t   addr;
+  uint8_t   fails;    // failures in a row, 0 = free slot
+  uint32_t  until;    // sysCnt the back-off ends at
+} i2c_dev_t;
+
+/* Private constants */
+static const i2c_speed_t i2cSpeeds[I2C_SPEED_COUNT] PROGMEM = {
+  I2C_PROFILE_SM,
+  I2C_PROFILE_FM,
+  I2C_PROFILE_FMP
+};
+
 /* Private variables */
 static volatile uint8_t _I2CREG_ = 0;
+static i2c_speed_t i2cSpd;          // the running profile
+static uint8_t i2cSpdId = I2C_SPEED_COUNT;
+static i2c_xfer_t* volatile qRing[I2C_QUEUE_SIZE];
+static volatile uint8_t qHead = 0;
+static volatile uint8_t qTail = 0;
+static i2c_xfer_t* qCur = NULL;     // transaction on the bus
+static uint8_t qState = 0;
+static uint8_t qIdx = 0;            // bytes done in the step
+static uint8_t qGap = 0;            // idle steps left
+static volatile uint8_t qOn = 0;    // the compare B steps are running
+static i2c_dev_t i2cDev[I2C_DEV_SLOTS];
+static uint8_t i2cMap[16];          // devices found by the boot scan, a bit per address
 
 /* Private function definitions */
+static inline void I2C_Delay(uint8_t) __attribute__((always_inline));
+static inline uint8_t I2C_WaitScl(void) __attribute__((always_inline));
 static void I2C_TransferBuffer(void);
+static uint8_t I2C_Open(void);
+static uint8_t I2C_Begin(void);
+static uint8_t I2C_StartCondition(void);
+static uint8_t I2C_StopCondition(void);
+static uint8_t I2C_PutByte(uint8_t);
+static uint8_t I2C_Probe(uint8_t);
+static void I2C_Account(uint8_t, uint8_t);
+static void I2C_Run(void);
+static void I2C_Schedule(void);
+static void I2C_Finish(uint8_t);
 
 
 /**
@@ -22,50 +70,191 @@ static void I2C_TransferBuffer(void);
  * @retval  none
  */
 void I2C_Start(void) {
+  PTRACE_ARM(PTRACE_I2C);
+  I2C_Open();
+}
+
+
+/**
+ * @brief   Opens a transaction, the bus is recovered first if needed. A
+ *          failure leaves the bus error flag set, the bytes up to the
+ *          STOP are not clocked then.
+ * @retval  (uint8_t) I2C_XS_DONE, I2C_XS_TIMEOUT or I2C_XS_BUS
+ */
+static uint8_t I2C_Open(void) {
+  uint8_t status;
+
+  TRACE(TRACE_BUS_START, BUS_I2C);
+  BusStat_Open(BUS_I2C);
+  status = I2C_Begin();
+  if (!status) status = I2C_StartCondition();
+  return status;
+}
+
+
+/**
+ * @brief   Checks the bus is free: a fault flagged earlier, or a line
+ *          found low, runs the recovery.
+ * @retval  (uint8_t) I2C_XS_DONE, I2C_XS_TIMEOUT or I2C_XS_BUS
+ */
+static uint8_t I2C_Begin(void) {
+  if (!FLAG_CHECK(_I2CREG_, _I2C_BERF_) &&
+      ((I2CPIN & (_BV(I2CSDA)|_BV(I2CSCL))) == (_BV(I2CSDA)|_BV(I2CSCL)))) {
+    return I2C_XS_DONE;
+  }
+  return I2C_Recover();
+}
+
+
+/**
+ * @brief   Frees the bus: clocks a slave stuck in a byte till it lets SDA
+ *          go, up to I2C_RECOVER_CLK clocks, then sends a STOP.
+ * @retval  (uint8_t) I2C_XS_DONE, I2C_XS_TIMEOUT or I2C_XS_BUS, the bus
+ *          error flag stays set on a failure
+ */
+uint8_t I2C_Recover(void) {
+  FLAG_CLR(_I2CREG_, _I2C_BERF_);
+  USIDR = 0xff;
+  SDA_OUT;
+  SDA_H;
   SCL_H;
-  _delay_us(1);
+  if (I2C_WaitScl()) return I2C_XS_TIMEOUT;
+
+  for (uint8_t i = 0; (i < I2C_RECOVER_CLK) && !(I2CPIN & _BV(I2CSDA)); i++) {
+    SCL_L;
+    I2C_Delay(i2cSpd.low);
+    SCL_H;
+    if (I2C_WaitScl()) return I2C_XS_TIMEOUT;
+    I2C_Delay(i2cSpd.high);
+  }
+  if (!(I2CPIN & _BV(I2CSDA))) {
+    FLAG_SET(_I2CREG_, _I2C_BERF_);
+    return I2C_XS_BUS;
+  }
+
+  SCL_L;
+  return I2C_StopCondition();
+}
+
+
+/**
+ * @brief   Drives the START, or the repeated START after an ACK bit.
+ * @retval  (uint8_t) I2C_XS_DONE or I2C_XS_TIMEOUT
+ */
+static uint8_t I2C_StartCondition(void) {
+  USIDR = 0xff;
+  I2C_Delay(i2cSpd.low);
+  SCL_H;
+  if (I2C_WaitScl()) return I2C_XS_TIMEOUT;
+  I2C_Delay(i2cSpd.suSta);
   SDA_L;
-  _delay_us(1);
+  I2C_Delay(i2cSpd.hdSta);
   SCL_L;
   SDA_H;
   USISR |= _BV(USISIF);
+  return I2C_XS_DONE;
 }
 
 
 /**
- * @brief   I2C stop condition.
+ * @brief   I2C stop condition. After a bus fault the lines are left to the
+ *          recovery of the next transaction.
  * @retval  none
  */
 void I2C_Stop(void) {
+  if (!FLAG_CHECK(_I2CREG_, _I2C_BERF_)) I2C_StopCondition();
+  BusStat_End(BUS_I2C);
+  BusStat_Close(BUS_I2C);
+  TRACE(TRACE_BUS_STOP, BUS_I2C);
+}
+
+
+/**
+ * @brief   Drives the STOP from a low SCL.
+ * @retval  (uint8_t) I2C_XS_DONE or I2C_XS_TIMEOUT
+ */
+static uint8_t I2C_StopCondition(void) {
   USIDR = 0x80;
   SDA_L;
+  I2C_Delay(i2cSpd.low);
   SCL_H;
-  while (!(I2CPIN & _BV(I2CSCL)));
-  _delay_us(1);
+  if (I2C_WaitScl()) return I2C_XS_TIMEOUT;
+  I2C_Delay(i2cSpd.suSto);
   SDA_H;
-  _delay_us(1);
+  I2C_Delay(i2cSpd.buf);
   USISR |= _BV(USIPF)|_BV(USISIF);
-  // USISR |= _BV(USISIF);
+  return I2C_XS_DONE;
+}
+
+
+/**
+ * @brief   Waits for SCL to go high, a slave may stretch the clock.
+ * @retval  (uint8_t) status of operation, 1 = SCL held low past
+ *          I2C_STRETCH_US, the bus error flag is set
+ */
+static inline uint8_t I2C_WaitScl(void) {
+  for (uint8_t n = I2C_STRETCH_US; !(I2CPIN & _BV(I2CSCL)); n--) {
+    if (!n) {
+      FLAG_SET(_I2CREG_, _I2C_BERF_);
+      return 1;
+    }
+    I2C_Delay(I2C_US_LOOPS);
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Waits in delay loops of I2C_LOOP_CYC cycles.
+ * @param   n loops, 0 returns at once
+ * @retval  none
+ */
+static inline void I2C_Delay(uint8_t n) {
+#if defined(HOST_BUILD)
+  Host_Spin((uint32_t)n * I2C_LOOP_CYC);
+#else
+  if (n) {
+    __asm__ __volatile__ (
+      "1: dec %0" "\n\t"
+      "brne 1b"
+      : "=r" (n)
+      : "0" (n)
+    );
+  }
+#endif
 }
 
 
 /**
- * @brief   I2C bus transfer data buffer.
+ * @brief   Switches the bus speed profile. Call it with the bus idle.
+ * @param   speed I2C_SPEED_*
+ * @retval  none
+ */
+void I2C_SetSpeed(uint8_t speed) {
+  if ((speed == i2cSpdId) || (speed >= I2C_SPEED_COUNT)) return;
+  memcpy_P(&i2cSpd, &i2cSpeeds[speed], sizeof(i2c_speed_t));
+  i2cSpdId = speed;
+}
+
+
+/**
+ * @brief   I2C bus transfer data buffer. Nothing is clocked after a bus
+ *          fault, a held SCL ends the transfer with the fault flagged.
  * @retval  none
  */
 static void I2C_TransferBuffer(void) {
   uint8_t tmp = 0;
 
+  if (FLAG_CHECK(_I2CREG_, _I2C_BERF_)) return;
   tmp = USICR;
   tmp |= _BV(USITC);
   while (!(USISR & _BV(USIOIF))) {
-    _delay_us(1);
+    I2C_Delay(i2cSpd.low);
     USICR = tmp;
-    while (!(I2CPIN & _BV(I2CSCL)));
-    _delay_us(1);
+    if (I2C_WaitScl()) return;
+    I2C_Delay(i2cSpd.high);
     USICR = tmp;
   }
-  _delay_us(1);
 }
 
 
@@ -137,14 +326,32 @@ void I2C_SendAddress(uint8_t addr) {
  */
 void I2C_SendByte(uint8_t byte) {
   FLAG_CLR(_I2CREG_, _I2C_ACKF_);
-  USIDR = byte;
-  I2C_Transfer();
-  if (!I2C_ReceiveAckNack()) {
+  if (!I2C_PutByte(byte)) {
     FLAG_SET(_I2CREG_, _I2C_ACKF_);
+  } else {
+    BusStat_Fail(BUS_I2C);
+    PTRACE_FREEZE(PTRACE_SITE_NACK);
   }
 }
 
 
+/**
+ * @brief   Shifts a byte out and reads the slave answer.
+ * @param   byte data byte
+ * @retval  (uint8_t) I2C_XS_DONE, I2C_XS_NACK or I2C_XS_TIMEOUT
+ */
+static uint8_t I2C_PutByte(uint8_t byte) {
+  uint8_t nack;
+
+  USIDR = byte;
+  I2C_Transfer();
+  BusStat_ByteTime(BUS_I2C, i2cSpd.byteUs);
+  nack = I2C_ReceiveAckNack();
+  if (FLAG_CHECK(_I2CREG_, _I2C_BERF_)) return I2C_XS_TIMEOUT;
+  return nack ? I2C_XS_NACK : I2C_XS_DONE;
+}
+
+
 /**
  * @brief   I2C bus receive a byte from slave.
  * @retval  (uint8_t) Received data byte
@@ -153,13 +360,347 @@ uint8_t I2C_ReceiveByte(void) {
   SDA_IN;
   I2C_Transfer();
   uint8_t byte = USIDR;
+  BusStat_ByteTime(BUS_I2C, i2cSpd.byteUs);
   I2C_SendAckNack();
   return (byte);
 }
 
 
+/**
+ * @brief   Writes a burst in one transaction: the address, the control byte
+ *          with I2C_XF_CTRL, then the buffer. The first failure ends it, a
+ *          device backing off is not addressed.
+ * @param   addr 7-bit slave address
+ * @param   ctrl control byte
+ * @param   buf data in RAM, or in flash with I2C_XF_PGM
+ * @param   len data length
+ * @param   flags I2C_XF_*
+ * @retval  (uint8_t) I2C_XS_* status
+ */
+uint8_t I2C_WriteBurst(uint8_t addr, uint8_t ctrl, const void* buf, uint16_t len, uint8_t flags) {
+  const uint8_t* b = (const uint8_t*)buf;
+  uint8_t step = (flags & I2C_XF_FILL) ? 0 : 1;
+  uint8_t status;
+
+  if (!I2C_Ready(addr)) return I2C_XS_BACKOFF;
+
+  PTRACE_ARM(PTRACE_I2C);
+  status = I2C_Open();
+  if (!status) status = I2C_PutByte(addr << 1);
+  if (status == I2C_XS_NACK) status = I2C_XS_ANACK;
+  if (!status && (flags & I2C_XF_CTRL)) status = I2C_PutByte(ctrl);
+
+  if (flags & I2C_XF_PGM) {
+    for (; !status && len; len--, b += step) status = I2C_PutByte(pgm_read_byte(b));
+  } else {
+    for (; !status && len; len--, b += step) status = I2C_PutByte(*b);
+  }
+
+  if (status) {
+    FLAG_CLR(_I2CREG_, _I2C_ACKF_);
+  } else {
+    FLAG_SET(_I2CREG_, _I2C_ACKF_);
+  }
+  I2C_Stop();
+  I2C_Account(addr, status);
+  return status;
+}
+
+
+/**
+ * @brief   Scans the bus at the Standard-mode pace, every slave takes it,
+ *          and keeps the addresses that answer. A bus fault ends the scan.
+ * @retval  (uint8_t) devices found
+ */
+uint8_t I2C_Scan(void) {
+  uint8_t n = 0;
+
+  for (uint8_t i = 0; i < sizeof(i2cMap); i++) i2cMap[i] = 0;
+  I2C_SetSpeed(I2C_SPEED_SM);
+
+  for (uint8_t addr = I2C_ADDR_FIRST; addr <= I2C_ADDR_LAST; addr++) {
+    uint8_t status = I2C_Probe(addr);
+    if (status == I2C_XS_ANACK) continue;
+    if (status) break;
+    i2cMap[addr >> 3] |= _BV(addr & 0x07);
+    n++;
+  }
+  return n;
+}
+
+
+/**
+ * @brief   Tells whether the boot scan found a device.
+ * @param   addr 7-bit slave address
+ * @retval  (uint8_t) 1 = found
+ */
+uint8_t I2C_Found(uint8_t addr) {
+  return (i2cMap[(addr >> 3) & 0x0f] & _BV(addr & 0x07)) ? 1 : 0;
+}
+
+
+/**
+ * @brief   Addresses a device for write and stops. A silent address is
+ *          not a failure here, it neither counts nor backs off.
+ * @param   addr 7-bit slave address
+ * @retval  (uint8_t) I2C_XS_DONE, I2C_XS_ANACK or a bus fault
+ */
+static uint8_t I2C_Probe(uint8_t addr) {
+  uint8_t status;
+
+  status = I2C_Open();
+  if (!status) status = I2C_PutByte(addr << 1);
+  if (status == I2C_XS_NACK) status = I2C_XS_ANACK;
+  I2C_Stop();
+  return status;
+}
+
+
+/**
+ * @brief   Tells whether a device may be addressed, a device backing off
+ *          is skipped till its time is up.
+ * @param   addr 7-bit slave address
+ * @retval  (uint8_t) 1 = ready, 0 = backing off
+ */
+uint8_t I2C_Ready(uint8_t addr) {
+  for (uint8_t i = 0; i < I2C_DEV_SLOTS; i++) {
+    i2c_dev_t* d = &i2cDev[i];
+    if (d->fails && (d->addr == addr)) return TIME_REACHED(Get_SysCnt(), d->until);
+  }
+  return 1;
+}
+
+
+/**
+ * @brief   Books a transaction outcome. A failure counts on the bus and
+ *          starts or doubles the device back-off, a success clears it.
+ * @param   addr 7-bit slave address
+ * @param   status I2C_XS_* status
+ * @retval  none
+ */
+static void I2C_Account(uint8_t addr, uint8_t status) {
+  i2c_dev_t* d = NULL;
+  i2c_dev_t* slot = NULL;
+
+  for (uint8_t i = 0; i < I2C_DEV_SLOTS; i++) {
+    if (!i2cDev[i].fails) {
+      slot = &i2cDev[i];
+    } else if (i2cDev[i].addr == addr) {
+      d = &i2cDev[i];
+    }
+  }
+
+  if (status == I2C_XS_DONE) {
+    if (d) d->fails = 0;
+    return;
+  }
+  if (status == I2C_XS_BACKOFF) return;
+
+  BusStat_Fail(BUS_I2C);
+  if ((status == I2C_XS_NACK) || (status == I2C_XS_ANACK)) PTRACE_FREEZE(PTRACE_SITE_NACK);
+
+  /* --- With all slots taken the device is retried every time --- */
+  if (!d) {
+    if (!slot) return;
+    d = slot;
+    d->addr = addr;
+  }
+  if (d->fails <= I2C_BACKOFF_MAX) d->fails++;
+  d->until = Get_SysCnt() + ((uint32_t)I2C_BACKOFF_MS << (d->fails - 1));
+}
+
+
+/**
+ * @brief   Queues a transaction. The queue runs from the interrupt, the
+ *          blocking calls above are for the start-up only.
+ * @param   x transaction, left untouched till it is done
+ * @retval  (uint8_t) status of operation, 1 = the queue is full
+ */
+uint8_t I2C_Submit(i2c_xfer_t* x) {
+  uint8_t status = 1;
+
+  IRQ_BLOCK {
+    uint8_t next = (qHead + 1) & (I2C_QUEUE_SIZE - 1);
+    if (next != qTail) {
+      x->status = I2C_XS_QUEUED;
+      qRing[qHead] = x;
+      qHead = next;
+      /* --- An idle queue takes its first step on the next Timer0 count --- */
+      if (!qOn) {
+        qOn = 1;
+        I2C_Schedule();
+        TIFR = _BV(OCF0B);
+        TIMSK |= _BV(OCIE0B);
+      }
+      status = 0;
+    }
+  }
+  return status;
+}
+
+
+/**
+ * @brief   Runs one queue step from the Timer0 compare B interrupt. The
+ *          bytes are clocked out with interrupts on and compare B masked,
+ *          so the tick comes in on time and the step never nests. The
+ *          master drives SCL, a tick inside a bit only stretches it. With
+ *          the kernel, the thread stacks hold one interrupt frame, so the
+ *          step keeps interrupts off.
+ * @retval  none
+ */
+void I2C_Step(void) {
+#if defined(KERNEL_PREEMPT)
+  I2C_Run();
+#else
+  TIMSK &= ~_BV(OCIE0B);
+  sei();
+  I2C_Run();
+  cli();
+  if (qOn) TIMSK |= _BV(OCIE0B);
+#endif
+}
+
+
+/**
+ * @brief   One queue step: START with the address and data bytes, as many
+ *          as the profile's step takes, or the idle time after a STOP. The
+ *          last byte takes the STOP along. The steps stop when the queue
+ *          is empty. A step takes up to about 110 us at 100 kHz, plus
+ *          I2C_STRETCH_US for each stretched clock.
+ * @retval  none
+ */
+static void I2C_Run(void) {
+  i2c_xfer_t* x = qCur;
+
+  if (!x) {
+    if (qGap) {
+      qGap--;
+      I2C_Schedule();
+      return;
+    }
+    if (qTail == qHead) {
+      qOn = 0;
+      TIMSK &= ~_BV(OCIE0B);
+      return;
+    }
+    x = qRing[qTail];
+    qTail = (qTail + 1) & (I2C_QUEUE_SIZE - 1);
+    x->status = I2C_XS_BUSY;
+    qCur = x;
+    qIdx = 0;
+    qState = I2C_ST_START;
+    if (!I2C_Ready(x->addr)) {
+      I2C_Finish(I2C_XS_BACKOFF);
+      return;
+    }
+    I2C_SetSpeed(x->speed);
+  } else {
+    BusStat_Begin(BUS_I2C);
+  }
+
+  uint8_t ctrl = (x->flags & I2C_XF_CTRL) ? 1 : 0;
+
+  for (uint8_t n = i2cSpd.step; n; n--) {
+    uint8_t status;
+
+    switch (qState) {
+      case I2C_ST_START:
+        /* --- A read-only transaction addresses for read at once --- */
+        qState = (x->wrLen || ctrl || !x->rdLen) ? I2C_ST_WRITE : I2C_ST_READ;
+        status = I2C_Open();
+        if (!status) status = I2C_PutByte((x->addr << 1) | ((qState == I2C_ST_READ) ? 0x01 : 0));
+        if (status == I2C_XS_NACK) status = I2C_XS_ANACK;
+        break;
+
+      case I2C_ST_WRITE:
+        if (ctrl && !qIdx) {
+          status = I2C_PutByte(x->ctrl);
+        } else {
+          const uint8_t* b = &x->wr[(x->flags & I2C_XF_FILL) ? 0 : qIdx - ctrl];
+          status = I2C_PutByte((x->flags & I2C_XF_PGM) ? pgm_read_byte(b) : *b);
+        }
+        qIdx++;
+        break;
+
+      case I2C_ST_RESTART:
+        TRACE(TRACE_BUS_START, BUS_I2C);
+        status = I2C_StartCondition();
+        if (!status) status = I2C_PutByte((x->addr << 1) | 0x01);
+        if (status == I2C_XS_NACK) status = I2C_XS_ANACK;
+        qState = I2C_ST_READ;
+        qIdx = 0;
+        break;
+
+      default:
+        /* --- The last byte read is answered with a NACK --- */
+        if (qIdx + 1 < x->rdLen) {
+          FLAG_SET(_I2CREG_, _I2C_ACKF_);
+        } else {
+          FLAG_CLR(_I2CREG_, _I2C_ACKF_);
+        }
+        x->rd[qIdx++] = I2C_ReceiveByte();
+        status = FLAG_CHECK(_I2CREG_, _I2C_BERF_) ? I2C_XS_TIMEOUT : I2C_XS_DONE;
+        break;
+    }
+
+    if (status) {
+      I2C_Finish(status);
+      return;
+    }
+    if ((qState == I2C_ST_WRITE) && (qIdx >= x->wrLen + ctrl)) {
+      if (!x->rdLen) {
+        I2C_Finish(I2C_XS_DONE);
+        return;
+      }
+      qState = I2C_ST_RESTART;
+    } else if ((qState == I2C_ST_READ) && (qIdx >= x->rdLen)) {
+      I2C_Finish(I2C_XS_DONE);
+      return;
+    }
+  }
+  BusStat_End(BUS_I2C);
+  I2C_Schedule();
+}
+
+
+/**
+ * @brief   Programs the next queue step, Timer0 runs in CTC mode, so a
+ *          count past OCR0A comes after the clear.
+ * @retval  none
+ */
+static void I2C_Schedule(void) {
+  uint8_t at = TCNT0 + I2C_STEP_CNT;
+
+  if (at > OCR0A) at -= OCR0A + 1;
+  OCR0B = at;
+}
+
+
+/**
+ * @brief   Sends the STOP and hands the transaction back. A transaction
+ *          skipped for the back-off never touched the bus.
+ * @param   status I2C_XS_* status
+ * @retval  none
+ */
+static void I2C_Finish(uint8_t status) {
+  i2c_xfer_t* x = qCur;
+
+  if (status != I2C_XS_BACKOFF) I2C_Stop();
+  I2C_Account(x->addr, status);
+  qCur = NULL;
+  qGap = status ? 0 : x->gap;
+  x->status = status;
+  if (x->done) x->done(x);
+  I2C_Schedule();
+}
+
+
 /* Getters */
 volatile uint8_t* Get_I2CREG(void) {
   return &_I2CREG_;
 }
 
+uint8_t Get_I2CSpeed(void) {
+  return i2cSpdId;
+}
+
@@ -18,6 +18,7 @@ static uint8_t addrBufLen = 8;
 
 /* Private function definitions */
 static void OneWire_WriteBit(uint8_t);
+static uint8_t OneWire_ReadSlot(void);
 static void OneWire_CollectAddresses(uint16_t);
 static uint8_t OneWire_Enumerate(uint8_t);
 
@@ -28,6 +29,7 @@ static uint8_t OneWire_Enumerate(uint8_t);
  */
 uint8_t Init_OneWire(void) {
   OW_SP_DOWN;
+  _OWREG_ = 0;
   
   if (!OneWire_Reset()) {
     OneWire_CollectAddresses(EE_OW_ADDR);
@@ -42,13 +44,29 @@ uint8_t Init_OneWire(void) {
  * @retval  (uint8_t) status of operation
  */
 uint8_t OneWire_Reset(void) {
+  PTRACE_ARM(PTRACE_OW);
+  TRACE(TRACE_BUS_START, BUS_OW);
+  BusStat_Close(BUS_OW);
+  BusStat_Open(BUS_OW);
   OW_UP;
   _delay_us(480);
-  OW_DOWN;
-  _delay_us(70);
-  if (OW_LEVEL) return 1; // error on the bus
+  uint8_t level;
+  /* --- An interrupt here would move the presence sample off the pulse --- */
+  IRQ_BLOCK {
+    OW_DOWN;
+    _delay_us(70);
+    level = OW_LEVEL;
+  }
+  if (level) {
+    PTRACE_FREEZE(PTRACE_SITE_PRESENCE);
+    BusStat_End(BUS_OW);
+    BusStat_Fail(BUS_OW);
+    BusStat_Close(BUS_OW);
+    return 1; // error on the bus
+  }
   OW_DOWN;
   _delay_us(410);
+  BusStat_End(BUS_OW);
   return 0; // no error on the bus
 }
 
@@ -59,31 +77,46 @@ uint8_t OneWire_Reset(void) {
  * @retval  none
  */
 static void OneWire_WriteBit(uint8_t bit) {
-  OW_L;
-  if (bit) {
-    _delay_us(6);
-    OW_H;
-    _delay_us(64);
-    } else {
-    _delay_us(60);
+  /* --- The low pulse is the bit, an interrupt must not stretch it --- */
+  IRQ_BLOCK {
+    OW_L;
+    _delay_us(bit ? 6 : 60);
     OW_H;
-    _delay_us(10);
   }
+  _delay_us(bit ? 64 : 10);
 }
 
 
 /**
- * @brief   Reads a bit from OneWire bus.
+ * @brief   Reads a bit from OneWire bus on its own, it polls a busy device.
+ *          The polls follow a function command, so they are bus time but
+ *          no part of the command transaction.
  * @retval  (uint8_t) bit to be read
  */
 uint8_t OneWire_ReadBit(void) {
+  BusStat_Close(BUS_OW);
+  BusStat_Begin(BUS_OW);
+  uint8_t bit = OneWire_ReadSlot();
+  BusStat_End(BUS_OW);
+  return bit;
+}
+
+
+/**
+ * @brief   Reads a bit from OneWire bus.
+ * @retval  (uint8_t) bit to be read
+ */
+static uint8_t OneWire_ReadSlot(void) {
   uint8_t bit = 0;
 
-  OW_L;
-  _delay_us(6);
-  OW_H;
-  _delay_us(9);
-  bit = OW_LEVEL;
+  /* --- The sample must fall within 15 us of the slot start --- */
+  IRQ_BLOCK {
+    OW_L;
+    _delay_us(6);
+    OW_H;
+    _delay_us(9);
+    bit = OW_LEVEL;
+  }
   _delay_us(55);
   
   return bit;
@@ -96,9 +129,12 @@ uint8_t OneWire_ReadBit(void) {
  * @retval  none
  */
 void OneWire_WriteByte(uint8_t data) {
+  BusStat_Begin(BUS_OW);
   for (uint8_t i = 0; i < 8; i++) {
     OneWire_WriteBit((data >> i) & 1);
   }
+  BusStat_Byte(BUS_OW);
+  BusStat_End(BUS_OW);
 }
 
 
@@ -108,23 +144,29 @@ void OneWire_WriteByte(uint8_t data) {
  */
 uint8_t OneWire_ReadByte(void) {
   uint8_t data = 0;
+  BusStat_Begin(BUS_OW);
   for (uint8_t i = 0; i < 8; i++) {
     data >>= 1;
-    data |= (OneWire_ReadBit()) ? 0x80 : 0;
+    data |= (OneWire_ReadSlot()) ? 0x80 : 0;
   }
+  BusStat_Byte(BUS_OW);
+  BusStat_End(BUS_OW);
   return data;
 }
 
 
 /**
  * @brief   Collects OneWire device addresses and writes them to EEPROM.
+ *          The search stops at OW_DEV_MAX devices.
  * @param   eepromAddr EEPROM pointer for storing addresses
  * @retval  none
  */
 static void OneWire_CollectAddresses(uint16_t eepromAddr) {
   lastfork = 65;
+  /* --- A fresh search must not follow the last found address --- */
+  for (uint8_t i = 0; i < addrBufLen; i++) addr[i] = 0;
   
-  while (!OneWire_Enumerate(SearchROM)) {
+  while (((_OWREG_ & 0x0f) < OW_DEV_MAX) && !OneWire_Enumerate(SearchROM)) {
     uint8_t crc = 0;
     for (uint8_t i = 0; i < addrBufLen; i++) {
       crc = OneWire_CRC(crc, addr[i]);
@@ -138,6 +180,8 @@ static void OneWire_CollectAddresses(uint16_t eepromAddr) {
       eepromAddr += addrBufLen;
       /* Increment OneWire device counter */
       _OWREG_ = (_OWREG_ & 0xf0) | ((_OWREG_ & 0x0f) + 1);
+    } else {
+      PTRACE_FREEZE(PTRACE_SITE_ROMCRC);
     }
   }
 }
@@ -145,13 +189,15 @@ static void OneWire_CollectAddresses(uint16_t eepromAddr) {
 
 /**
  * @brief   Collects OneWire device addresses in alarm state and writes them to EEPROM.
+ *          The search stops at OW_DEV_MAX devices.
  * @param   eepromAddr EEPROM pointer for storing addresses
  * @retval  none
  */
 void OneWire_CollectAlarms(uint16_t eepromAddr) {
   lastfork = 65;
+  for (uint8_t i = 0; i < addrBufLen; i++) addr[i] = 0;
   
-  while (OneWire_Enumerate(SearchAlarmROM)) {
+  while (((_OWREG_ >> 4) < OW_DEV_MAX) && OneWire_Enumerate(SearchAlarmROM)) {
     uint8_t crc = 0;
     for (uint8_t i = 0; i < addrBufLen; i++) {
       crc = OneWire_CRC(crc, addr[i]);
@@ -205,9 +251,10 @@ static uint8_t OneWire_Enumerate(uint8_t cmd) {
 
   OneWire_WriteByte(cmd);
 
+  BusStat_Begin(BUS_OW);
   for(uint8_t i = 1; i < 65; i++) {
-    bit0 = OneWire_ReadBit();
-    bit1 = OneWire_ReadBit();
+    bit0 = OneWire_ReadSlot();
+    bit1 = OneWire_ReadSlot();
 
     if (!bit0) {
       if (!bit1) {
@@ -227,6 +274,8 @@ static uint8_t OneWire_Enumerate(uint8_t cmd) {
       if (!bit1) {
         curr |= 0x80;
       } else {
+        PTRACE_FREEZE(PTRACE_SITE_SEARCH);
+        BusStat_End(BUS_OW);
         return 1;
       }
     }
@@ -244,6 +293,7 @@ static uint8_t OneWire_Enumerate(uint8_t cmd) {
     }
     bp--;
   }
+  BusStat_End(BUS_OW);
   lastfork = fork;
   return 0;
 }
@@ -257,8 +307,11 @@ static uint8_t OneWire_Enumerate(uint8_t cmd) {
 uint8_t OneWire_ReadPowerSupply(uint8_t* addr) {
   OneWire_MatchROM(addr);
   OneWire_WriteByte(ReadPowerSupply);
-  
-  return !OneWire_ReadBit();
+
+  BusStat_Begin(BUS_OW);
+  uint8_t bit = OneWire_ReadSlot();
+  BusStat_End(BUS_OW);
+  return !bit;
 }
 
 
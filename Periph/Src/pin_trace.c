@@ -0,0 +1,160 @@
+/*
+ * Filename: pin_trace.c
+ * Description: The file contains the optional bus pin trace. A bus driver
+ *              arms it at the start of a transaction, the pin change
+ *              interrupt stores the line edges with their Timer1 time, and
+ *              the first bus failure freezes the capture for an EEPROM dump.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:14:27 AM
+ * Author: Dmitry Slobodchikov
+ */
+#include "pin_trace.h"
+
+#if defined(PIN_TRACE)
+
+/* Private constants */
+/* --- Lines of each traced bus --- */
+static const uint8_t busPins[PTRACE_BUSES] PROGMEM = {
+  _BV(OW0PIN),
+  _BV(I2CSDA)|_BV(I2CSCL),
+  _BV(DSPLDIO)|_BV(DSPLCLK)
+};
+
+/* Private variables */
+static volatile uint8_t ring[PTRACE_SIZE];
+static volatile ptrace_hdr_t hdr;
+static volatile uint8_t lastCnt    = 0;   // Timer1 at the previous edge
+static volatile uint8_t lastLevels = 0;   // traced line levels after the previous edge
+static uint16_t arms[PTRACE_BUSES];
+static uint8_t  frozen  = 0;
+static uint8_t  stored  = 0;              // the capture is in EEPROM
+static uint8_t  dumped  = 0;              // entries written to EEPROM
+
+
+
+/**
+ * @brief   Starts Timer1 for the edge time. A capture already in EEPROM is
+ *          kept until the EEPROM is erased, the trace stays off then.
+ * @retval  none
+ */
+void Init_PinTrace(void) {
+  uint8_t magic = 0;
+
+  _INIT_PTRACE;
+  EEPROM_ReadBuffer(EE_PTRACE_ADDR, &magic, 1);
+  if (magic == PTRACE_MAGIC) {
+    frozen = 1;
+    stored = 1;
+  }
+}
+
+
+/**
+ * @brief   Starts a capture at the beginning of a bus transaction, the lines
+ *          of the bus are traced from here on.
+ * @param   bus traced bus
+ * @retval  none
+ */
+void PinTrace_Arm(uint8_t bus) {
+  arms[bus]++;
+  if (frozen) return;
+
+  uint8_t pins = pgm_read_byte(&busPins[bus]);
+  IRQ_BLOCK {
+    hdr.bus = bus;
+    hdr.arms = arms[bus];
+    hdr.count = 0;
+    hdr.lost = 0;
+    lastCnt = TCNT1;
+    lastLevels = PINB & pins;
+    hdr.levels = lastLevels;
+    TIFR = _BV(TOV1);
+    GIFR = _BV(PCIF);
+    PCMSK = pins;
+  }
+}
+
+
+/**
+ * @brief   Stops the capture on the first bus failure.
+ * @param   site failure
+ * @retval  none
+ */
+void PinTrace_Freeze(uint8_t site) {
+  if (frozen) return;
+  PCMSK = 0;
+  hdr.site = site;
+  hdr.magic = PTRACE_MAGIC;
+  frozen = 1;
+}
+
+
+/**
+ * @brief   Writes a frozen capture into EEPROM, a chunk per call, and the
+ *          header last, so a dump cut by a reset is not taken as valid.
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t PinTrace_Scheduler(void) {
+  if (!frozen || stored) return 0;
+
+  uint8_t n = hdr.count - dumped;
+  if (n > PTRACE_DUMP_CHUNK) n = PTRACE_DUMP_CHUNK;
+  if (n) {
+    EEPROM_WriteBuffer(EE_PTRACE_ADDR + sizeof(ptrace_hdr_t) + dumped, (uint8_t*)&ring[dumped], n);
+    dumped += n;
+    return 0;
+  }
+  EEPROM_WriteBuffer(EE_PTRACE_ADDR, (uint8_t*)&hdr, sizeof(ptrace_hdr_t));
+  stored = 1;
+  return 0;
+}
+
+
+/**
+ * @brief   Pin change interrupt routine, stores the edges of the traced
+ *          lines. A line the MCU pulls low gives no entry, its time is the
+ *          reference of the next one.
+ * @retval  none
+ */
+ISR(PCINT0_vect) {
+  uint8_t cnt = TCNT1;
+  uint8_t levels = PINB & PCMSK;
+  uint8_t changed = levels ^ lastLevels;
+  uint8_t mcuLow = DDRB & ~PORTB;
+  uint8_t dt = cnt - lastCnt;
+  uint8_t idx = 0;
+
+  /* --- A wrap with the counter past the reference is a long gap --- */
+  if (TIFR & _BV(TOV1)) {
+    TIFR = _BV(TOV1);
+    if (cnt >= lastCnt) dt = PTRACE_DT_MAX;
+  }
+  if (dt > PTRACE_DT_MAX) dt = PTRACE_DT_MAX;
+  lastCnt = cnt;
+  lastLevels = levels;
+
+  for (uint8_t bit = _BV(PB0); bit <= _BV(PB4); bit <<= 1) {
+    if (!(PTRACE_PINS & bit)) continue;
+    if ((changed & bit) && ((levels & bit) || !(mcuLow & bit))) {
+      uint8_t e = (idx << 6) | ((levels & bit) ? 0 : 0x20) | dt;
+      if (hdr.count < PTRACE_SIZE) {
+        ring[hdr.count++] = e;
+      } else if (hdr.lost < 0xff) {
+        hdr.lost++;
+      }
+      /* --- Edges seen together are stored together --- */
+      dt = 0;
+    }
+    idx++;
+  }
+}
+
+
+/* Getters */
+const ptrace_hdr_t* PinTrace_Header(void) {
+  return (const ptrace_hdr_t*)&hdr;
+}
+
+#endif /* PIN_TRACE */
@@ -7,17 +7,21 @@
  * Created: 15.08.2025 06:25:48 AM
  * Author: Dmitry Slobodchikov
 */ 
-#ifndef TMPR_H_
-#define TMPR_H_
+#ifndef DIGD_H_
+#define DIGD_H_
 
 
 #include "main.h"
 
 /* --- Periodial step value --- */
-#define DIGD_SRV_STEP  500 // here is a millis value that derives from sysCnt
+#define DIGD_SRV_STEP  500 // here is a tick value that derives from sysCnt
 
 
-uint8_t GetTemperature_Scheduler(void);
+uint8_t PrintDigitalDisplay_Scheduler(void);
 
+#if defined(KERNEL_PREEMPT)
+  void PrintDigitalDisplay_Thread(void);
+#endif
 
-#endif /* TMPR_H_ */
\ No newline at end of file
+
+#endif /* DIGD_H_ */
\ No newline at end of file
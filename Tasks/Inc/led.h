@@ -19,10 +19,14 @@
 #define LED0PIN   PINB1
 
 /* --- Periodial step value --- */
-#define LED_SRV_STEP  500 // here is a sec value that derives from sysCnt
+#define LED_SRV_STEP  500 // here is a tick value that derives from sysCnt
 
 
 uint8_t LedToggle_Scheduler(void);
 
+#if defined(KERNEL_PREEMPT)
+  void LedToggle_Thread(void);
+#endif
+
 
 #endif /* LED_H_ */
\ No newline at end of file
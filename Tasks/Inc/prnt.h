@@ -12,12 +12,20 @@
 
 
 #include "main.h"
+#include <inttypes.h>
 
 /* --- Periodial step value --- */
-#define PRNT_SRV_STEP  1 // here is a millis value that derives from sysCnt
+#define PRNT_SRV_STEP  (1 * SEC_TICKS) // here is a tick value, once a second
 
 
 uint8_t Print_Scheduler(void);
 
+#if defined(SCHED_PROFILE)
+  /* --- Profile dump step value --- */
+  #define PROF_SRV_STEP  (10 * SEC_TICKS) // here is a tick value, every 10 seconds
+
+  uint8_t PrintProfile_Scheduler(void);
+#endif
+
 
 #endif /* PRNT_H_ */
\ No newline at end of file
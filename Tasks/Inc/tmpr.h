@@ -7,18 +7,19 @@
  * Created: 13.08.2025 08:55:29 PM
  * Author: Dmitry Slobodchikov
 */ 
-#ifndef DIGD_H_
-#define DIGD_H_
+#ifndef TMPR_H_
+#define TMPR_H_
 
 
 #include "main.h"
 
 /* --- Periodial step value --- */
-#define TMPR_SRV_STEP  4 // here is a sec value that derives from secCnt
+#define TMPR_SRV_STEP  (4 * SEC_TICKS) // here is a tick value, every 4 seconds
 
 
-uint8_t PrintDigitalDisplay_Scheduler(void);
+uint8_t GetTemperature_Scheduler(void);
+uint8_t GetTemperature_Restart(void);
 uint8_t* Get_Spad(void);
 
 
-#endif /* DIGD_H_ */
\ No newline at end of file
+#endif /* TMPR_H_ */
\ No newline at end of file
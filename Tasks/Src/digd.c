@@ -9,27 +9,38 @@
 */ 
 #include "digd.h"
 
-/* Private variables */
-static uint16_t taskCnt = DIGD_SRV_STEP;
-
 /* Private function definitions */
 static uint8_t PrintDigitalDisplay_Handler(void);
 
 
 
 /**
- * @brief   Sets up a scheduler for digital display printing.
+ * @brief   Digital display printing task, dispatched every DIGD_SRV_STEP ticks
+ *          when the digital display is ready.
  * @retval  (uint8_t) status of operation
  */
 uint8_t PrintDigitalDisplay_Scheduler(void) {
-  if (!(--taskCnt)) {
+  return PrintDigitalDisplay_Handler();
+}
+
+
+#if defined(KERNEL_PREEMPT)
+/**
+ * @brief   Digital display printing kernel thread, wakes every DIGD_SRV_STEP
+ *          ticks, prints when the digital display is ready and checks in
+ *          with the supervisor.
+ * @retval  none
+ */
+void PrintDigitalDisplay_Thread(void) {
+  while (1) {
     if (FLAG_CHECK(*Get_PREG(), _DIGDRF_)) {
-      if (PrintDigitalDisplay_Handler()) return 1;
+      PrintDigitalDisplay_Handler();
     }
-    taskCnt = DIGD_SRV_STEP;
+    Kernel_CheckIn();
+    Kernel_Sleep(DIGD_SRV_STEP);
   }
-  return 0;
 }
+#endif
 
 
 /**
@@ -38,7 +49,7 @@ uint8_t PrintDigitalDisplay_Scheduler(void) {
  */
 static uint8_t PrintDigitalDisplay_Handler(void) {
   static uint8_t digs[4] = {0x0b, 0x0b, 0x0b, 0x0b};
-  uint16_t secCnt = Get_SecCnt();
+  uint16_t secCnt = Get_SecCnt() % 10000;
 
   digs[0] = secCnt/1000%10;
   if (secCnt < 1000) digs[0] = 11;
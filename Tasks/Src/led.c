@@ -9,25 +9,34 @@
 */ 
 #include "led.h"
 
-/* Private variables */
-static uint16_t taskCnt = LED_SRV_STEP;
-
 /* Private function definitions */
 static uint8_t LedToggle_Handler(void);
 
 
 
 /**
- * @brief   Sets up a scheduler for LED toggling.
+ * @brief   LED toggling task, dispatched every LED_SRV_STEP ticks.
  * @retval  (uint8_t) status of operation
  */
 uint8_t LedToggle_Scheduler(void) {
-  if (!(--taskCnt)) {
-    if (LedToggle_Handler()) return 1;
-     taskCnt = LED_SRV_STEP;
+  return LedToggle_Handler();
+}
+
+
+#if defined(KERNEL_PREEMPT)
+/**
+ * @brief   LED toggling kernel thread, wakes every LED_SRV_STEP ticks and
+ *          checks in with the supervisor.
+ * @retval  none
+ */
+void LedToggle_Thread(void) {
+  while (1) {
+    LedToggle_Handler();
+    Kernel_CheckIn();
+    Kernel_Sleep(LED_SRV_STEP);
   }
-  return 0;
 }
+#endif
 
 
 /**
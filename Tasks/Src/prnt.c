@@ -9,32 +9,40 @@
 */ 
 #include "prnt.h"
 
-/* Private variables */
-static uint16_t taskCnt = PRNT_SRV_STEP;
-
-
 /* Private function definitions */
 static uint8_t PrintSec_Handler(void);
 static uint8_t PrintTmpr_Handler(void);
+static uint8_t PrintIdle_Handler(void);
+#if !defined(HOST_BUILD)
+  static uint8_t PrintStack_Handler(void);
+#endif
+static uint8_t PrintBus_Handler(void);
 
 
 
 /**
- * @brief   Sets up a scheduler for printing.
+ * @brief   Printing task, dispatched every PRNT_SRV_STEP ticks when
+ *          the display is ready.
  * @retval  (uint8_t) status of operation
  */
 uint8_t Print_Scheduler(void) {
-  if (!(--taskCnt)) {
-    if (FLAG_CHECK(*Get_PREG(), _DSPLRF_)) {
-      if (Get_SecCnt() % 5) {
-        if (PrintSec_Handler()) return 1;
-      } else {
-        if (PrintTmpr_Handler()) return 1;
-      }
-    }
-    taskCnt = PRNT_SRV_STEP;
+  switch (Get_SecCnt() % 5) {
+    case 0:
+      return PrintTmpr_Handler();
+    case 2:
+      return PrintBus_Handler();
+    case 3:
+      return PrintIdle_Handler();
+    case 4:
+#if defined(HOST_BUILD)
+      /* --- The host stack says nothing of the AVR one --- */
+      return PrintSec_Handler();
+#else
+      return PrintStack_Handler();
+#endif
+    default:
+      return PrintSec_Handler();
   }
-  return 0;
 }
 
 
@@ -43,7 +51,7 @@ uint8_t Print_Scheduler(void) {
  * @retval  (uint8_t) status of operation
  */
 static uint8_t PrintSec_Handler(void) {
-  printf("sec:%u\n", Get_SecCnt());
+  printf("sec:%" PRIu32 "\n", Get_SecCnt());
   return 0;
 }
 
@@ -57,3 +65,108 @@ static uint8_t PrintTmpr_Handler(void) {
   printf("T:%d.%02u\n", (int8_t)(*t1 >> 4), (uint8_t)(((*t1 & 0x000f) * 100) >> 4));
   return 0;
 }
+
+
+/**
+ * @brief   Handles printing of idle statistics and of the longest wake-up
+ *          latency, followed by the events dropped on a full ring and the
+ *          display characters dropped on a full text ring once there are
+ *          any. When measured, every other call prints
+ *          the longest interrupts-off window, the longest tick latency
+ *          at a window end and the window site instead.
+ * @retval  (uint8_t) status of operation
+ */
+static uint8_t PrintIdle_Handler(void) {
+#if defined(IRQ_PROFILE)
+  static uint8_t turn = 0;
+  if ((turn ^= 1) == 0) {
+    irq_stat_t irq;
+    IRQ_BLOCK {
+      irq = *Get_IrqStat();
+    }
+    printf("ix:%" PRIu32 "us t%" PRIu32 "us @%04x\n", (uint32_t)(irq.longest * IRQ_US_PER_CNT),
+      (uint32_t)(irq.tickLat * IRQ_US_PER_CNT), irq.site);
+    return 0;
+  }
+#endif
+  uint8_t pct = Get_IdlePercent();
+  uint16_t drop = Event_Overflows();
+  uint16_t txt = Dspl_Drops();
+  uint16_t wl = Get_IdleStat()->wakeLatMax;
+  if (drop | txt) {
+    printf("slp:%u%% wl:%uus ev-%u d-%u\n", pct, wl, drop, txt);
+  } else {
+    printf("slp:%u%% wl:%uus\n", pct, wl);
+  }
+  return 0;
+}
+
+
+
+#if !defined(HOST_BUILD)
+/**
+ * @brief   Handles printing of the RAM budget, and of one task stack peak
+ *          per call when sampled.
+ * @retval  (uint8_t) status of operation
+ */
+static uint8_t PrintStack_Handler(void) {
+  stack_report_t rep;
+  Stack_Report(&rep);
+#if defined(STACK_PROFILE)
+  static uint8_t task = 0;
+  printf("stk:%u fr:%u t%u:%u\n", rep.highWater, rep.headroom, task, Scheduler_GetStackPeak(task));
+  if (++task >= Scheduler_TaskCount()) task = 0;
+#else
+  printf("stk:%u fr:%u\n", rep.highWater, rep.headroom);
+#endif
+  return 0;
+}
+#endif
+
+
+/**
+ * @brief   Handles printing of one bus utilization per call, in turn: busy
+ *          share of the time, padding share of the busy time, the longest
+ *          transaction in us, transactions, bytes and failures since the
+ *          bus was printed last.
+ * @retval  (uint8_t) status of operation
+ */
+static uint8_t PrintBus_Handler(void) {
+  static uint8_t bus = 0;
+  bus_stat_t st;
+
+  BusStat_Snapshot(bus, &st);
+  BusStat_Reset(bus);
+
+  uint32_t windowMs = (st.window * BUS_US_PER_CNT) / 1000;
+  uint16_t busy = windowMs ? (uint16_t)(st.busy / windowMs) : 0; // 0.1%
+  uint8_t pad = 0;
+  if (st.busy) {
+    pad = (st.pad >= st.busy) ? 100 : (uint8_t)((st.pad * 100) / st.busy);
+  }
+  printf("%c b%u.%u%% p%u%% x%" PRIu32 " n%u B%u f%u\n", "OID"[bus], busy / 10, busy % 10, pad,
+    (uint32_t)(st.longest * BUS_US_PER_CNT), st.trans, st.bytes, st.fails);
+  if (++bus >= BUS_COUNT) bus = 0;
+  return 0;
+}
+
+
+#if defined(SCHED_PROFILE)
+/**
+ * @brief   Prints runtime statistics of one task per call, in turn.
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t PrintProfile_Scheduler(void) {
+  static uint8_t task = 0;
+  const prof_stat_t* stat = Scheduler_GetProfile(task);
+
+  if (stat->calls) {
+    printf("%u n%u o%" PRIu32 " a%" PRIu32 " x%" PRIu32 " m%" PRIu32 "\n", task, stat->calls, stat->overruns,
+      (uint32_t)((stat->sum / stat->calls) * PROF_US_PER_CNT),
+      (uint32_t)(stat->max * PROF_US_PER_CNT),
+      (uint32_t)(stat->min * PROF_US_PER_CNT));
+  }
+  if (++task >= Scheduler_TaskCount()) task = 0;
+  return 0;
+}
+#endif
@@ -11,10 +11,11 @@
 
 /* Private variables */
 volatile static uint8_t* _owreg;
-volatile static uint8_t* _dsreg;
-static uint16_t taskCnt = TMPR_SRV_STEP;
 static uint8_t curAddr[8];
 static uint8_t spad[9];
+static pt_t taskPt;
+static pt_t hndlPt;
+static pt_t convPt;
 
 
 /* Private function definitions */
@@ -22,42 +23,70 @@ static uint8_t GetTemperatur_Handler(uint8_t);
 
 
 /**
- * @brief   Sets up a scheduler for temperature measurement.
+ * @brief   Temperature measurement task, dispatched every TMPR_SRV_STEP ticks
+ *          when the OneWire bus is ready. Coroutine, stays PT_WAITING while
+ *          the conversion runs.
  * @retval  (uint8_t) status of operation
  */
 uint8_t GetTemperature_Scheduler(void) {
-  if (!FLAG_CHECK(*Get_PREG(), _OWBUSRF_)) return 1;
-  if (FLAG_CHECK(*Get_DSREG(), _DSDF_)) return 1;
-
-  if (!(--taskCnt)) {
-    _owreg = Get_OWREG();
-    // for (uint8_t i = 0; i < (*_owreg & 0x0f); i++) {
-      //   if (GetTemperatur_Handler(i)) printf("Fail:%u\n", i);
-      // }
-    /* --- Get tepmperatur from the given device "0" --- */
-    if (GetTemperatur_Handler(0)) {
-      /* --- on error, set up -128.00 C --- */
-      spad[0] = 0x00;
-      spad[1] = 0x08;
-    }
-    taskCnt = TMPR_SRV_STEP;
+  uint8_t status = 0;
+
+  PT_BEGIN(&taskPt);
+  _owreg = Get_OWREG();
+  // for (uint8_t i = 0; i < (*_owreg & 0x0f); i++) {
+    //   if (GetTemperatur_Handler(i)) printf("Fail:%u\n", i);
+    // }
+  /* --- Get tepmperatur from the given device "0", the conversion lets go of the bus while it waits --- */
+  BUS_LOCK(KM_OW);
+  PT_SPAWN(&taskPt, status, GetTemperatur_Handler(0));
+  BUS_UNLOCK(KM_OW);
+  if (status) {
+    /* --- on error, set up -128.00 C --- */
+    spad[0] = 0x00;
+    spad[1] = 0x08;
   }
-  return 0;
+  PT_END(&taskPt);
 }
 
 
 /**
  * @brief   Handles a temperature measurement.
+ *          Coroutine, resumes the conversion until it completes.
  * @param   num a sequential number in the list of devices enumerated by OneWire bus
- * @retval  (uint8_t) status of operation
+ * @retval  (uint8_t) status of operation, PT_WAITING while converting
  */
 static uint8_t GetTemperatur_Handler(uint8_t num) {
-  if (num >= *_owreg) return 1;
+  uint8_t status = 0;
+
+  PT_BEGIN(&hndlPt);
+  if (num >= *_owreg) PT_EXIT(&hndlPt, 1);
+
+  if (EEPROM_ReadBuffer(EE_OW_ADDR + (num * 8), curAddr, 8)) PT_EXIT(&hndlPt, 1);
+  PT_SPAWN(&hndlPt, status, DS18B20_ConvertTemperature(&convPt, curAddr));
+  if (status) PT_EXIT(&hndlPt, 1);
+  if (DS18B20_ReadScrachpad(curAddr, spad)) PT_EXIT(&hndlPt, 1);
+
+  PT_END(&hndlPt);
+}
 
-  if (EEPROM_ReadBuffer(EE_OW_ADDR + (num * 8), curAddr, 8)) return 1;
-  if (DS18B20_ConvertTemperature(curAddr)) return 1;
-  if (DS18B20_ReadScrachpad(curAddr, spad)) return 1;
 
+/**
+ * @brief   Restarts the temperature measurement and the OneWire driver,
+ *          called by the supervisor when the task misses its budget.
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t GetTemperature_Restart(void) {
+  OW_SP_DOWN;
+  BUS_UNLOCK(KM_OW);
+  FLAG_CLR(*Get_DSREG(), _DSDF_);
+  PT_INIT(&taskPt);
+  PT_INIT(&hndlPt);
+  PT_INIT(&convPt);
+
+  if (Init_OneWire()) {
+    FLAG_CLR(*Get_PREG(), _OWBUSRF_);
+    return 1;
+  }
   return 0;
 }
 
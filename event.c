@@ -0,0 +1,60 @@
+/*
+ * Filename: event.c
+ * Description: The file contains the ISR to main loop event ring.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:20:14 AM
+ * Author: Dmitry Slobodchikov
+ */ 
+
+#include "main.h"
+
+/* Private variables */
+static volatile event_ring_t evRing;
+
+
+
+/**
+ * @brief   Pops the oldest event from the ring, main loop only.
+ * @param   ev pointer to the event to fill
+ * @retval  (uint8_t) 1 - an event is popped, 0 - the ring is empty
+ */
+uint8_t Event_Pop(event_t* ev) {
+  uint8_t tail = evRing.tail;
+  if (tail == evRing.head) return 0;
+
+  ev->type = evRing.buf[tail].type;
+  ev->arg = evRing.buf[tail].arg;
+  /* --- Release the slot only after it has been copied out --- */
+  evRing.tail = (tail + 1) & EVENT_RING_MASK;
+  return 1;
+}
+
+
+/**
+ * @brief   Checks whether the ring holds events.
+ * @retval  (uint8_t) 1 - events are pending, 0 - the ring is empty
+ */
+uint8_t Event_Pending(void) {
+  return (evRing.tail != evRing.head);
+}
+
+
+/**
+ * @brief   Gives the number of events dropped on a full ring.
+ * @retval  (uint16_t) overflow counter
+ */
+uint16_t Event_Overflows(void) {
+  uint16_t cnt;
+  IRQ_BLOCK {
+    cnt = evRing.overflow;
+  }
+  return cnt;
+}
+
+
+/* Getters */
+volatile event_ring_t* Get_EventRing(void) {
+  return &evRing;
+}
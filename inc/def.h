@@ -14,14 +14,37 @@
 #include "main.h"
 
 
-#define SYS_TICK_THOLD  194
-#define SEC_TICK_MASK   0x03ff
+/* --- Timer0 CTC @ clk/1024, counts per 1 ms tick in 16.16 fixed point --- */
+#define SYS_TICK_Q16    ((uint32_t)(((uint64_t)F_CPU << 16) / 1024 / 1000))
+#define SYS_TICK_PPM    20000 // calibration limit, twice the 1% of a user-calibrated RC oscillator
+#define EE_TICK_CAL     0x0000 // EEPROM address of the oscillator error, int16_t ppm
+
+/* --- Tickless idle, ticks per Timer0 period --- */
+#define IDLE_MAX_STEP   15
+#define IDLE_US_PER_CNT (1024000000UL / F_CPU) // microseconds per clk/1024 count
+#define SEC_TICKS       1000
+
+
+/* System tick control shared with Timer0 ISR */
+typedef struct {
+  uint8_t   cur;    // ticks in the running Timer0 period
+  uint8_t   next;   // ticks in the next Timer0 period, one-shot
+  uint8_t   whole;  // whole Timer0 counts per tick
+  uint16_t  frac;   // fractional Timer0 counts per tick, 1/65536 units
+  uint16_t  acc;    // fractional count accumulator
+  uint32_t  counts; // Timer0 counts of the finished periods
+} systick_t;
+
+/* Idle statistics, the window is restarted by Get_IdlePercent() */
+typedef struct {
+  uint32_t  winTicks;     // ticks in the current window
+  uint32_t  winSleep;     // Timer0 counts slept in the current window
+  uint16_t  wakeLatLast;  // last wake-up latency, us
+  uint16_t  wakeLatMax;   // worst wake-up latency, us
+  uint8_t   sleepPct;     // percentage of time asleep in the last window
+} idle_stat_t;
 
 
-/* System flag definitions */
-#define _SYSTF_   0 // System Tick Flag
-#define _SECTF_   1 // Seconds Tick Flag
-
 /* Peripherals rediness flag definitions */
 #define _DSPLRF_  0 // Display Ready Flag
 #define _DIGDRF_  1 // Digital Display Ready Flag
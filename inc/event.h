@@ -0,0 +1,78 @@
+/*
+ * Filename: event.h
+ * Description: A set of definitions for the ISR to main loop event ring.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:20:14 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef EVENT_H_
+#define EVENT_H_
+
+
+#include "main.h"
+
+
+/* --- Ring size, power of two --- */
+#define EVENT_RING_SIZE   8
+#define EVENT_RING_MASK   (EVENT_RING_SIZE - 1)
+
+/* --- Maximum events handled in one Cron() pass --- */
+#define EVENT_BATCH       EVENT_RING_SIZE
+
+
+/* Event type definitions */
+#define EV_TICK     0 // System tick(s), arg - number of ticks
+
+
+typedef struct {
+  uint8_t   type;
+  uint8_t   arg;
+} event_t;
+
+/* --- Single producer (the tick interrupt) single consumer (main loop) ring --- */
+typedef struct {
+  event_t   buf[EVENT_RING_SIZE];
+  uint8_t   head;     // written by the producer only
+  uint8_t   tail;     // written by the consumer only
+  uint16_t  overflow; // events dropped on a full ring
+} event_ring_t;
+
+
+/**
+ * @brief   Pushes an event into the ring, interrupt context only. Ticks add
+ *          to the newest tick event, unless it is the only one pending, the
+ *          consumer may be copying that one out.
+ * @param   ring pointer to the event ring
+ * @param   type event type
+ * @param   arg event argument
+ * @retval  (uint8_t) 0 - pushed, 1 - ring is full, event is dropped
+ */
+static inline uint8_t Event_PushISR(volatile event_ring_t* ring, uint8_t type, uint8_t arg) {
+  uint8_t head = ring->head;
+  uint8_t last = (head - 1) & EVENT_RING_MASK;
+  if ((type == EV_TICK) && (((head - ring->tail) & EVENT_RING_MASK) > 1) &&
+      (ring->buf[last].type == EV_TICK) && (ring->buf[last].arg <= UINT8_MAX - arg)) {
+    ring->buf[last].arg += arg;
+    return 0;
+  }
+  if (((head + 1) & EVENT_RING_MASK) == ring->tail) {
+    ring->overflow++;
+    return 1;
+  }
+  ring->buf[head].type = type;
+  ring->buf[head].arg = arg;
+  ring->head = (head + 1) & EVENT_RING_MASK;
+  return 0;
+}
+
+
+/* Exported functions */
+uint8_t Event_Pop(event_t*);
+uint8_t Event_Pending(void);
+uint16_t Event_Overflows(void);
+volatile event_ring_t* Get_EventRing(void);
+
+
+#endif /* EVENT_H_ */
@@ -0,0 +1,48 @@
+/*
+ * Filename: irq.h
+ * Description: A set of definitions for the scoped atomic sections.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:41:17 AM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef IRQ_H_
+#define IRQ_H_
+
+
+#include "main.h"
+
+
+/* --- Interrupts-off window measurement, Timer0 @ clk/1024 --- */
+// #define IRQ_PROFILE
+
+#define IRQ_US_PER_CNT  IDLE_US_PER_CNT
+
+
+/* Longest interrupts-off window since start */
+typedef struct {
+  uint16_t  longest;  // window length, Timer0 counts
+  uint16_t  site;     // return address of its Irq_Save(), words on AVR
+  uint16_t  tickLat;  // longest tick held off at a window end, Timer0 counts
+  uint16_t  held;     // windows that held a tick off
+} irq_stat_t;
+
+
+/* --- IRQ_BLOCK { ... } runs the block with interrupts off and restores --- */
+/* --- the entry state on any exit, so the blocks nest. Only the outer one --- */
+/* --- is measured, an inner one finds interrupts already off --- */
+#if defined(IRQ_PROFILE)
+  /* Exported functions */
+  uint8_t Irq_Save(void);
+  void Irq_Restore(const uint8_t*);
+  irq_stat_t* Get_IrqStat(void);
+
+  #define IRQ_BLOCK   for (uint8_t _irqSreg __attribute__((__cleanup__(Irq_Restore))) = Irq_Save(), \
+                           _irqOnce = 1; _irqOnce; _irqOnce = 0)
+#else
+  #define IRQ_BLOCK   ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+#endif
+
+
+#endif /* IRQ_H_ */
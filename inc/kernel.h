@@ -0,0 +1,137 @@
+/*
+ * Filename: kernel.h
+ * Description: A set of definitions for the optional preemptive mini-kernel.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:31:16 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef KERNEL_H_
+#define KERNEL_H_
+
+
+#include "main.h"
+
+
+/* --- Preemptive mode, LED and digital display run as kernel threads --- */
+// #define KERNEL_PREEMPT
+
+#if defined(KERNEL_PREEMPT) && defined(HOST_BUILD)
+  #error "KERNEL_PREEMPT switches AVR stacks and is not available in the host build"
+#endif
+
+
+/* --- Priority levels, the main loop is the background thread --- */
+#define KPRIO_IDLE        0
+#define KPRIO_NORMAL      1
+#define KPRIO_HIGH        2
+
+/* --- Thread states --- */
+#define KSTATE_READY      0
+#define KSTATE_SLEEP      1
+#define KSTATE_BLOCKED    2
+
+/* --- Statically allocated thread stacks, bytes --- */
+/* --- Interrupts do not nest, so a thread needs its own deepest frame plus the larger
+       of the two interrupt frames that land on it:
+       - tick: 2 PC + 2 call + 33 context + 14 Kernel_Switch() = 51
+       - compare B: 2 PC + 15 ISR prologue + 56 for I2C_Step() -> I2C_Finish() ->
+         Dspl_Done() -> Dspl_Next() with the next transaction queued = 73
+       LED 8 + 73 = 81, digital display 24 + 73 = 97, plus 16 spare each --- */
+#define KERNEL_STACK_LED  96
+#define KERNEL_STACK_DIGD 112
+
+/* --- Bus mutexes --- */
+#define KM_I2C            0
+#define KM_OW             1 // OneWire, PB4 is shared with the digital display
+#define KM_COUNT          2
+#define KM_NOOWNER        0xff
+
+
+/* --- Thread descriptor, lives in flash --- */
+typedef struct {
+  void      (*entry)(void); // thread function, never returns
+  uint8_t*  stack;          // stack memory
+  uint8_t   size;           // stack size
+  uint8_t   prio;           // priority level
+  uint16_t  budget;         // ticks allowed between check-ins
+} kthread_t;
+
+/* --- Thread control block --- */
+typedef struct {
+  uint16_t  sp;     // saved stack pointer
+  uint32_t  wake;   // system tick to wake up at
+  uint8_t   prio;
+  uint8_t   state;
+  uint8_t   wait;   // mutex the thread is blocked on
+  uint32_t  checkIn; // system tick of the last check-in
+} ktcb_t;
+
+
+/* --- Context save/restore, the same frame for the tick and a yield --- */
+#define KERNEL_SAVE_CONTEXT() __asm__ __volatile__ ( \
+  "push r0                \n" \
+  "in   r0, __SREG__      \n" \
+  "cli                    \n" \
+  "push r0                \n" \
+  "push r1                \n" \
+  "clr  r1                \n" \
+  "push r2                \n push r3                \n push r4                \n push r5  \n" \
+  "push r6                \n push r7                \n push r8                \n push r9  \n" \
+  "push r10               \n push r11               \n push r12               \n push r13 \n" \
+  "push r14               \n push r15               \n push r16               \n push r17 \n" \
+  "push r18               \n push r19               \n push r20               \n push r21 \n" \
+  "push r22               \n push r23               \n push r24               \n push r25 \n" \
+  "push r26               \n push r27               \n push r28               \n push r29 \n" \
+  "push r30               \n push r31               \n" \
+)
+
+#define KERNEL_RESTORE_CONTEXT() __asm__ __volatile__ ( \
+  "pop  r31               \n pop  r30               \n" \
+  "pop  r29               \n pop  r28               \n pop  r27               \n pop  r26 \n" \
+  "pop  r25               \n pop  r24               \n pop  r23               \n pop  r22 \n" \
+  "pop  r21               \n pop  r20               \n pop  r19               \n pop  r18 \n" \
+  "pop  r17               \n pop  r16               \n pop  r15               \n pop  r14 \n" \
+  "pop  r13               \n pop  r12               \n pop  r11               \n pop  r10 \n" \
+  "pop  r9                \n pop  r8                \n pop  r7                \n pop  r6  \n" \
+  "pop  r5                \n pop  r4                \n pop  r3                \n pop  r2  \n" \
+  "pop  r1                \n" \
+  "pop  r0                \n" \
+  "out  __SREG__, r0      \n" \
+  "pop  r0                \n" \
+)
+
+/* --- Hands the saved SP to Kernel_Switch() and loads the chosen one --- */
+#define KERNEL_SWITCH() __asm__ __volatile__ ( \
+  "in   r24, __SP_L__     \n" \
+  "in   r25, __SP_H__     \n" \
+  "rcall Kernel_Switch    \n" \
+  "out  __SP_H__, r25     \n" \
+  "out  __SP_L__, r24     \n" \
+)
+
+
+#if defined(KERNEL_PREEMPT)
+  /* Exported functions */
+  void Init_Kernel(void);
+  void Kernel_Tick(void) __attribute__((naked));
+  void Kernel_Yield(void) __attribute__((naked));
+  uint16_t Kernel_Switch(uint16_t);
+  void Kernel_Sleep(uint16_t);
+  void Kernel_Lock(uint8_t);
+  void Kernel_Unlock(uint8_t);
+  void Kernel_CheckIn(void);
+  uint8_t Kernel_Supervise(void);
+  uint8_t Kernel_Running(void);
+  void SysTick_ISR(void);
+
+  #define BUS_LOCK(m)     Kernel_Lock(m)
+  #define BUS_UNLOCK(m)   Kernel_Unlock(m)
+#else
+  #define BUS_LOCK(m)     do {} while (0)
+  #define BUS_UNLOCK(m)   do {} while (0)
+#endif
+
+
+#endif /* KERNEL_H_ */
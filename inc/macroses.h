@@ -20,8 +20,17 @@
 #define FLAG_CHECK(reg, flag)   (reg & _BV(flag))
 
 
+/* Wrap-safe time comparison macroses, valid for spans under 2^31 ticks */
+#define TIME_ELAPSED(now, since)    ((uint32_t)((now) - (since)))
+#define TIME_REACHED(now, deadline) ((int32_t)((now) - (deadline)) >= 0)
+
+
 /* No operation masros */
-#define _NOP do {__asm__ __volatile__ ("nop");} while(0)
+#if defined(HOST_BUILD)
+  #define _NOP do {Host_Advance(HOST_NOP_CYCLES);} while(0)
+#else
+  #define _NOP do {__asm__ __volatile__ ("nop");} while(0)
+#endif
 
 
 
@@ -26,10 +26,19 @@
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
 #include <avr/wdt.h>
+#include <avr/sleep.h>
+#include <util/atomic.h>
 #include <avr/iotn85.h>
 
 #include "def.h"
 #include "macroses.h"
+#include "sched.h"
+#include "pt.h"
+#include "event.h"
+#include "stack.h"
+#include "irq.h"
+#include "wdg.h"
+#include "kernel.h"
 #include "init_periph.h"
 #include "led.h"
 #include "i2c.h"
@@ -38,6 +47,9 @@
 #include "eeprom.h"
 #include "ow.h"
 #include "ds18b20.h"
+#include "pin_trace.h"
+#include "bus_stat.h"
+#include "trace.h"
 
 #include "digd.h"
 #include "tmpr.h"
@@ -48,14 +60,21 @@
 /* Exported functions */
 volatile uint8_t* Get_GREG(void);
 volatile uint8_t* Get_PREG(void);
-volatile uint16_t* Get_SysCnt(void);
-volatile uint16_t Get_SecCnt(void);
+volatile uint32_t* Get_SysCntReg(void);
+uint32_t Get_SysCnt(void);
+uint32_t Get_SecCnt(void);
+uint32_t Get_TimerCnt(void);
+volatile systick_t* Get_SysTick(void);
+idle_stat_t* Get_IdleStat(void);
+uint8_t Get_IdlePercent(void);
 
 FILE* Init_DsplOut(void);
+void Set_TickCal(int16_t);
+void Save_TickCal(int16_t);
 
 void Init_ISR(void);
 void _delay_us(uint16_t);
-void _delay_ms(uint16_t, volatile uint8_t*, uint8_t);
+uint16_t Get_DelayUs(void);
 uint8_t cmpBBufs(uint8_t*, uint8_t*, uint16_t);
 
 
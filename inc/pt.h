@@ -0,0 +1,73 @@
+/*
+ * Filename: pt.h
+ * Description: A set of stackless coroutine (protothread) macroses. 
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 02:41:07 PM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef PT_H_
+#define PT_H_
+
+
+#include "main.h"
+
+
+/* --- A coroutine keeps its resume point and wait start, locals do not survive a wait --- */
+typedef struct {
+  uint16_t  lc; // local continuation, source line to resume at
+  uint32_t  t0; // sysCnt value the current wait started at
+} pt_t;
+
+
+/* --- Coroutine status, besides the usual 0 - success, 1 - error --- */
+#define PT_WAITING    0x80
+
+
+/* Coroutine body management macroses */
+#define PT_INIT(pt)   (pt)->lc = 0
+
+#define PT_BEGIN(pt)  switch ((pt)->lc) { case 0:
+
+#define PT_END(pt)    } (pt)->lc = 0; return 0
+
+#define PT_EXIT(pt, status) do { \
+  (pt)->lc = 0; \
+  return (status); \
+} while (0)
+
+
+/* --- The resume labels are entered on purpose from the line above them --- */
+#define PT_FALLTHROUGH  __attribute__((fallthrough))
+
+
+/* Coroutine waiting macroses */
+#define PT_AWAIT_UNTIL(pt, cond) do { \
+  (pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+  if (!(cond)) return PT_WAITING; \
+} while (0)
+
+#define PT_YIELD(pt) do { \
+  (pt)->lc = __LINE__; \
+  return PT_WAITING; \
+  case __LINE__:; \
+} while (0)
+
+#define PT_AWAIT_FLAG(pt, reg, flag)  PT_AWAIT_UNTIL(pt, FLAG_CHECK(reg, flag))
+
+#define PT_AWAIT_MS(pt, ms) do { \
+  (pt)->t0 = Get_SysCnt(); \
+  Scheduler_Defer(ms); \
+  (pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+  if (TIME_ELAPSED(Get_SysCnt(), (pt)->t0) < (ms)) return PT_WAITING; \
+} while (0)
+
+/* --- Runs a child coroutine to completion, its status goes to rc --- */
+#define PT_SPAWN(pt, rc, child) do { \
+  (pt)->lc = __LINE__; PT_FALLTHROUGH; case __LINE__: \
+  if (((rc) = (child)) == PT_WAITING) return PT_WAITING; \
+} while (0)
+
+
+#endif /* PT_H_ */
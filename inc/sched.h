@@ -0,0 +1,70 @@
+/*
+ * Filename: sched.h
+ * Description: A set of definitions for the table-driven task scheduler.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:12:40 AM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef SCHED_H_
+#define SCHED_H_
+
+
+#include "main.h"
+
+
+/* --- Per-task runtime profiler, Timer1 @ clk/64 --- */
+// #define SCHED_PROFILE
+
+#define PROF_US_PER_CNT   (64000000UL / F_CPU) // microseconds per Timer1 count
+
+
+/* --- Task has no readiness dependency on _PREG_ --- */
+#define SCHED_NORF    0xff
+/* --- Delta queue end of list marker --- */
+#define SCHED_NIL     0xff
+
+
+/* --- Task descriptor, lives in flash --- */
+typedef struct {
+  uint16_t  period;           // period in system ticks
+  uint16_t  phase;            // first run offset in system ticks
+  uint16_t  budget;           // longest allowed gap between check-ins, ticks
+  uint8_t   (*handler)(void); // task handler
+  uint8_t   (*restart)(void); // driver restart hook, or NULL to reset the MCU
+  uint8_t   rflag;            // readiness flag in _PREG_, or SCHED_NORF
+} sched_task_t;
+
+
+/* --- Task runtime statistics, in Timer1 counts --- */
+typedef struct {
+  uint16_t  min;      // shortest run
+  uint16_t  max;      // longest run
+  uint32_t  sum;      // total runtime, for the average
+  uint16_t  calls;    // number of dispatches
+  uint32_t  overruns; // system ticks missed while the task was running
+} prof_stat_t;
+
+
+/* Exported functions */
+void Init_Scheduler(void);
+void Scheduler_Tick(void);
+uint16_t Scheduler_NextDue(void);
+void Scheduler_Defer(uint16_t);
+uint8_t Scheduler_TaskCount(void);
+uint8_t Scheduler_Supervise(void);
+volatile uint8_t* Get_SchedRunning(void);
+
+#if defined(STACK_PROFILE)
+  uint16_t Scheduler_GetStackPeak(uint8_t);
+#endif
+
+#if defined(SCHED_PROFILE)
+  const prof_stat_t* Scheduler_GetProfile(uint8_t);
+  void Scheduler_ResetProfile(void);
+  volatile uint16_t* Get_ProfOvf(void);
+#endif
+
+
+#endif /* SCHED_H_ */
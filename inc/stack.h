@@ -0,0 +1,48 @@
+/*
+ * Filename: stack.h
+ * Description: A set of definitions for stack usage and RAM budget reports.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 01:05:52 PM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef STACK_H_
+#define STACK_H_
+
+
+#include "main.h"
+
+
+/* --- Per-task stack peaks sampled at each scheduler dispatch --- */
+// #define STACK_PROFILE
+
+#if defined(STACK_PROFILE) && defined(HOST_BUILD)
+  #error "STACK_PROFILE scans the AVR stack and is not available in the host build"
+#endif
+
+/* --- Free RAM is painted with this pattern before main() --- */
+#define STACK_CANARY    0xc5
+
+
+/* RAM budget report, in bytes */
+typedef struct {
+  uint16_t  total;      // SRAM size
+  uint16_t  static_;    // .data and .bss
+  uint16_t  highWater;  // deepest stack since start
+  uint16_t  headroom;   // never touched RAM between .bss and the stack
+} stack_report_t;
+
+
+/* Exported functions */
+uint16_t Stack_HighWater(void);
+uint16_t Stack_Headroom(void);
+void Stack_Report(stack_report_t*);
+
+#if defined(STACK_PROFILE)
+  void Stack_Rewind(void);
+  uint16_t Stack_Sample(void);
+#endif
+
+
+#endif /* STACK_H_ */
@@ -0,0 +1,91 @@
+/*
+ * Filename: trace.h
+ * Description: A set of definitions for the binary event trace.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 11:20:48 AM
+ * Author: Dmitry Slobodchikov
+*/
+#ifndef TRACE_H_
+#define TRACE_H_
+
+
+#include "main.h"
+
+
+/* --- Event trace, Timer1 @ clk/8 locked to Timer0 --- */
+// #define EVENT_TRACE
+
+#if defined(EVENT_TRACE) && (defined(SCHED_PROFILE) || defined(PIN_TRACE))
+  #error "EVENT_TRACE, SCHED_PROFILE and PIN_TRACE all run Timer1"
+#endif
+
+
+/* --- Ring of the last events, 4 bytes each --- */
+#define TRACE_SIZE        32
+#define TRACE_NS_PER_CNT  (8000000000ULL / F_CPU) // nanoseconds per Timer1 count
+#define TRACE_LONG_US     60000                   // a dispatch this long freezes the ring
+#define TRACE_SRV_STEP    250                     // frozen ring dump step, ticks
+#define TRACE_DUMP_CHUNK  16                      // EEPROM bytes written per dump step
+
+/* --- EEPROM image of a frozen ring, shared with the pin trace --- */
+#define EE_TRACE_ADDR     0x0140
+#define TRACE_MAGIC       0xa9
+
+/* --- Event types in [7:4] of the id, [3:0] is the argument --- */
+#define TRACE_TASK_IN     0x10 // task dispatch, task index
+#define TRACE_TASK_OUT    0x20 // task return, task index
+#define TRACE_ISR         0x30 // interrupt entry, vector number
+#define TRACE_BUS_START   0x40 // START, 1-Wire reset or TM1637 start, bus
+#define TRACE_BUS_STOP    0x50 // STOP or TM1637 stop, bus
+#define TRACE_CONV_BEGIN  0x60 // DS18B20 conversion started
+#define TRACE_CONV_END    0x70 // DS18B20 conversion done
+#define TRACE_SLEEP       0x80 // core goes to Idle sleep
+#define TRACE_WAKE        0x90 // core woke up with an event pending
+
+#define TRACE_TYPE(id)    ((id) & 0xf0)
+#define TRACE_ARG(id)     ((id) & 0x0f)
+
+/* --- Traced vectors --- */
+#define TRACE_VEC_TIM0    10
+#define TRACE_VEC_WDT     12
+
+/* --- Freeze reasons --- */
+#define TRACE_WHY_CALL    0 // Trace_Freeze() called
+#define TRACE_WHY_LONG    1 // a dispatch took over TRACE_LONG_US
+
+
+/* --- An event. Timer1 wraps every two Timer0 counts in step with it, so --- */
+/* --- bit 7 of t1 repeats bit 0 of t0 and the time is t0 * 128 + (t1 & 0x7f) --- */
+/* --- Timer1 counts. Differing bits mean Timer0 counted between the two --- */
+/* --- reads, t0 is one less then --- */
+typedef struct {
+  uint8_t   id;
+  uint8_t   t1;       // Timer1
+  uint16_t  t0;       // Get_TimerCnt(), low half
+} trace_ev_t;
+
+/* --- Frozen ring header, EEPROM image layout, events follow oldest first --- */
+typedef struct {
+  uint8_t   magic;
+  uint8_t   count;    // events kept
+  uint8_t   why;      // freeze reason
+  uint8_t   task;     // the long task, TRACE_WHY_LONG only
+} trace_hdr_t;
+
+
+#if defined(EVENT_TRACE)
+  /* Exported functions */
+  void Init_Trace(void);
+  void Trace_Event(uint8_t);
+  void Trace_Freeze(uint8_t);
+  uint8_t Trace_Scheduler(void);
+
+  #define TRACE(type, arg)  Trace_Event((type) | (arg))
+#else
+  #define TRACE(type, arg)  do {} while (0)
+#endif
+
+
+#endif /* TRACE_H_ */
@@ -0,0 +1,43 @@
+/*
+ * Filename: wdg.h
+ * Description: A set of definitions for the task watchdog supervisor.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 04:47:31 PM
+ * Author: Dmitry Slobodchikov
+*/ 
+#ifndef WDG_H_
+#define WDG_H_
+
+
+#include "main.h"
+
+
+/* --- Post-mortem record is valid --- */
+#define WDG_MAGIC     0xa5
+/* --- No task to blame --- */
+#define WDG_NONE      0xff
+/* --- Hang outside any task, scheduler or interrupt code --- */
+#define WDG_IDLE      0xfe
+/* --- A kernel thread to blame, its number in [6:0] --- */
+#define WDG_THREAD    0x80
+
+
+/* Post-mortem record, survives a watchdog reset in .noinit */
+typedef struct {
+  uint8_t   magic;
+  uint8_t   culprit;  // task blamed for the pending reset, WDG_THREAD | thread, WDG_IDLE or WDG_NONE
+  uint8_t   resets;   // watchdog resets since power-on
+} wdg_pm_t;
+
+
+/* Exported functions */
+void Init_Wdg(uint8_t);
+void Wdg_Service(void);
+uint8_t Wdg_LastCulprit(void);
+uint8_t Wdg_Resets(void);
+volatile wdg_pm_t* Get_WdgPm(void);
+
+
+#endif /* WDG_H_ */
@@ -0,0 +1,73 @@
+/*
+ * Filename: irq.c
+ * Description: The file contains the measured atomic sections. Each outer
+ *              IRQ_BLOCK is timed on Timer0, the longest one is kept with
+ *              its call site.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 09:41:17 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include "main.h"
+
+#if defined(IRQ_PROFILE)
+
+/* Private variables */
+static irq_stat_t irqStat = {0, 0, 0, 0};
+static uint16_t   offAt   = 0;        // Timer0 at the outer cli()
+static uint16_t   offSite = 0;
+
+
+
+/**
+ * @brief   Turns interrupts off and starts the window if they were on.
+ *          Not inlined, so the return address is the IRQ_BLOCK site.
+ * @retval  (uint8_t) SREG on entry
+ */
+__attribute__((noinline)) uint8_t Irq_Save(void) {
+  uint8_t sreg = SREG;
+
+  cli();
+  if (sreg & _BV(SREG_I)) {
+    offAt = (uint16_t)Get_TimerCnt();
+    offSite = (uint16_t)(uintptr_t)__builtin_return_address(0);
+  }
+  return sreg;
+}
+
+
+/**
+ * @brief   Closes the window opened by the matching Irq_Save() and turns
+ *          interrupts back on if they were on. A window over one tick
+ *          period is seen one period short, the tick latency covers it.
+ * @param   sreg SREG saved on entry
+ * @retval  none
+ */
+void Irq_Restore(const uint8_t* sreg) {
+  if (!(*sreg & _BV(SREG_I))) return;
+
+  uint16_t len = (uint16_t)Get_TimerCnt() - offAt;
+  if (len >= irqStat.longest) {
+    irqStat.longest = len;
+    irqStat.site = offSite;
+  }
+
+  /* --- A compare match came during the window, the tick waits since --- */
+  if (TIFR & _BV(OCF0A)) {
+    uint8_t lat = TCNT0;
+    irqStat.held++;
+    if (lat > irqStat.tickLat) irqStat.tickLat = lat;
+  }
+  sei();
+}
+
+
+/* Getters */
+
+irq_stat_t* Get_IrqStat(void) {
+  return &irqStat;
+}
+
+#endif /* IRQ_PROFILE */
@@ -11,8 +11,14 @@
 #include "main.h"
 
 /* Private variables */
-volatile static uint8_t* _greg;
-volatile static uint16_t* _sysCnt;
+volatile static event_ring_t* _evRing;
+volatile static wdg_pm_t* _wdgPm;
+volatile static uint8_t* _schedRunning;
+volatile static uint32_t* _sysCnt;
+volatile static systick_t* _sysTick;
+#if defined(SCHED_PROFILE)
+  volatile static uint16_t* _profOvf;
+#endif
 
 
 /**
@@ -20,27 +26,120 @@ volatile static uint16_t* _sysCnt;
  * @retval  none
  */
 void Init_ISR(void) {
-  _greg = Get_GREG();
-  _sysCnt = Get_SysCnt();
+  _evRing = Get_EventRing();
+  _wdgPm = Get_WdgPm();
+  _schedRunning = Get_SchedRunning();
+  _sysCnt = Get_SysCntReg();
+  _sysTick = Get_SysTick();
+#if defined(SCHED_PROFILE)
+  _profOvf = Get_ProfOvf();
+#endif
 }
 
 
+/* Private function definitions */
+static inline void SysTick_Body(void) __attribute__((always_inline));
+
+
+/**
+ * @brief   System tick work of the Timer0 compare match interrupt.
+ * @retval  none
+ */
+static inline void SysTick_Body(void) {
+  uint8_t ticks = _sysTick->cur;
+  uint8_t step = _sysTick->next;
+  uint8_t whole = _sysTick->whole;
+  uint16_t frac = _sysTick->frac;
+  uint16_t acc = _sysTick->acc;
+  uint8_t cnt = 0;
+
+  /* --- The finished period adds to the Timer0 clock, traced after it --- */
+  _sysTick->counts += (uint16_t)OCR0A + 1;
+  TRACE(TRACE_ISR, TRACE_VEC_TIM0);
+
+  /* --- Program the next period, the fraction carries into whole counts --- */
+  for (uint8_t i = 0; i < step; i++) {
+    cnt += whole;
+    acc += frac;
+    if (acc < frac) cnt++;
+  }
+  OCR0A = cnt - 1;
+  _sysTick->acc = acc;
+  _sysTick->cur = step;
+  _sysTick->next = 1;
+
+  (*_sysCnt) += ticks;
+
+  /* --- Ticks add up in the ring, only a full one drops them --- */
+  Event_PushISR(_evRing, EV_TICK, ticks);
+}
+
+
+#if defined(KERNEL_PREEMPT)
+/**
+ * @brief   Timer0 (TIM0) compare match interrupt routine. The kernel saves
+ *          the running thread, does the tick work and may switch threads.
+ * @retval  none
+ */
+ISR(TIMER0_COMPA_vect, ISR_NAKED) {
+  Kernel_Tick();
+  reti();
+}
+
+
+/**
+ * @brief   System tick work, called by the kernel on the interrupted stack.
+ * @retval  none
+ */
+void SysTick_ISR(void) {
+  SysTick_Body();
+}
+#else
+/**
+ * @brief   Timer0 (TIM0) compare match interrupt routine.
+ *          The counter is cleared by hardware, so ISR latency adds no drift.
+ * @retval  none
+ */
+ISR(TIMER0_COMPA_vect) {
+  SysTick_Body();
+}
+#endif
+
+
+/**
+ * @brief   Timer0 (TIM0) compare B interrupt routine, one I2C queue step.
+ * @retval  none
+ */
+ISR(TIMER0_COMPB_vect) {
+  I2C_Step();
+}
+
+
+#if defined(SCHED_PROFILE)
 /**
- * @brief   Timer0 (TIM0) interrupt routine.
+ * @brief   Timer1 (TIM1) interrupt routine, extends the profiler counter.
  * @retval  none
  */
-ISR(TIMER0_OVF_vect) {
-  TCNT0 = SYS_TICK_THOLD;
-  FLAG_SET(*_greg, _SYSTF_);
-  (*_sysCnt)++;
+ISR(TIMER1_OVF_vect) {
+  (*_profOvf)++;
 }
+#endif
 
 
 /**
- * @brief   Watchdog (WDG) interrupt routine.
+ * @brief   Watchdog (WDG) interrupt routine. The watchdog has not been fed
+ *          in time: blame the running task, if nobody is blamed yet, and
+ *          leave WDIE cleared, so the next timeout resets the MCU.
  * @retval  none
  */
 ISR(WDT_vect) {
-  wdt_reset();
-  WDTCR |= _BV(WDCE)|_BV(WDIE);
+  TRACE(TRACE_ISR, TRACE_VEC_WDT);
+  if (_wdgPm->culprit == WDG_NONE) {
+    uint8_t task = *_schedRunning;
+    _wdgPm->culprit = (task == SCHED_NIL) ? WDG_IDLE : task;
+#if defined(KERNEL_PREEMPT)
+    /* --- The tasks run in the main loop thread, another thread is to blame itself --- */
+    if (Kernel_Running()) _wdgPm->culprit = WDG_THREAD | Kernel_Running();
+#endif
+  }
 }
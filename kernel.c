@@ -0,0 +1,219 @@
+/*
+ * Filename: kernel.c
+ * Description: The file contains the optional preemptive mini-kernel.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:31:16 AM
+ * Author: Dmitry Slobodchikov
+ */ 
+
+#include "main.h"
+
+#if defined(KERNEL_PREEMPT)
+
+/* Private variables */
+static uint8_t stackLed[KERNEL_STACK_LED];
+static uint8_t stackDigd[KERNEL_STACK_DIGD];
+
+/* Thread descriptor table, the main loop is thread 0 and is not listed */
+const kthread_t kThreads[] PROGMEM = {
+  {LedToggle_Thread,           stackLed,  sizeof(stackLed),  KPRIO_HIGH,   2 * LED_SRV_STEP},
+  {PrintDigitalDisplay_Thread, stackDigd, sizeof(stackDigd), KPRIO_NORMAL, 2 * DIGD_SRV_STEP}
+};
+
+#define KERNEL_THREADS (sizeof(kThreads) / sizeof(kthread_t) + 1)
+
+static ktcb_t kTcb[KERNEL_THREADS];
+static volatile uint8_t kCur = 0;
+static volatile uint8_t kMutex[KM_COUNT];
+
+
+
+/**
+ * @brief   Builds the initial frame of every thread, as if it had been
+ *          saved by a yield right before its entry point.
+ * @retval  none
+ */
+void Init_Kernel(void) {
+  kTcb[0].prio = KPRIO_IDLE;
+  kTcb[0].state = KSTATE_READY;
+
+  for (uint8_t i = 1; i < KERNEL_THREADS; i++) {
+    const kthread_t* desc = &kThreads[i - 1];
+    uint8_t* sp = (uint8_t*)pgm_read_ptr(&desc->stack) + pgm_read_byte(&desc->size) - 1;
+    uint16_t pc = (uint16_t)pgm_read_ptr(&desc->entry);
+
+    /* --- Return address, low byte first, as CALL does --- */
+    *sp-- = (uint8_t)pc;
+    *sp-- = (uint8_t)(pc >> 8);
+    /* --- r0, SREG with interrupts on, r1 = 0, r2..r31 --- */
+    *sp-- = 0x00;
+    *sp-- = _BV(SREG_I);
+    for (uint8_t r = 1; r < 32; r++) *sp-- = 0x00;
+
+    kTcb[i].sp = (uint16_t)sp;
+    kTcb[i].prio = pgm_read_byte(&desc->prio);
+    kTcb[i].state = KSTATE_READY;
+    kTcb[i].checkIn = Get_SysCnt();
+  }
+
+  for (uint8_t i = 0; i < KM_COUNT; i++) kMutex[i] = KM_NOOWNER;
+}
+
+
+/**
+ * @brief   Saves the running thread, does the system tick work and switches
+ *          to the highest priority ready thread. Called from the tick ISR.
+ * @retval  none
+ */
+void Kernel_Tick(void) {
+  KERNEL_SAVE_CONTEXT();
+  SysTick_ISR();
+  KERNEL_SWITCH();
+  KERNEL_RESTORE_CONTEXT();
+  __asm__ __volatile__ ("ret");
+}
+
+
+/**
+ * @brief   Gives up the CPU to the highest priority ready thread.
+ * @retval  none
+ */
+void Kernel_Yield(void) {
+  KERNEL_SAVE_CONTEXT();
+  KERNEL_SWITCH();
+  KERNEL_RESTORE_CONTEXT();
+  __asm__ __volatile__ ("ret");
+}
+
+
+/**
+ * @brief   Stores the stack pointer of the running thread, wakes up due
+ *          sleepers and picks the next thread. Interrupts are off. With
+ *          no thread ready, the running one goes on and spins in its
+ *          sleep or lock loop until a tick wakes a sleeper.
+ * @param   sp stack pointer of the running thread
+ * @retval  (uint16_t) stack pointer of the thread to run
+ */
+uint16_t Kernel_Switch(uint16_t sp) {
+  uint32_t now = Get_SysCnt();
+  uint8_t next = KERNEL_THREADS;
+
+  kTcb[kCur].sp = sp;
+  for (uint8_t i = 0; i < KERNEL_THREADS; i++) {
+    if ((kTcb[i].state == KSTATE_SLEEP) && (TIME_REACHED(now, kTcb[i].wake))) {
+      kTcb[i].state = KSTATE_READY;
+    }
+    if ((kTcb[i].state == KSTATE_READY) && ((next == KERNEL_THREADS) || (kTcb[i].prio > kTcb[next].prio))) {
+      next = i;
+    }
+  }
+  if (next == KERNEL_THREADS) return sp;
+  kCur = next;
+  return kTcb[next].sp;
+}
+
+
+/**
+ * @brief   Puts the running thread to sleep for the given number of ticks.
+ *          The main loop thread must not sleep, it idles instead.
+ * @param   ticks sleep time in system ticks
+ * @retval  none
+ */
+void Kernel_Sleep(uint16_t ticks) {
+  IRQ_BLOCK {
+    kTcb[kCur].wake = Get_SysCnt() + ticks;
+    kTcb[kCur].state = KSTATE_SLEEP;
+  }
+  do {
+    Kernel_Yield();
+  } while (kTcb[kCur].state == KSTATE_SLEEP);
+}
+
+
+/**
+ * @brief   Takes the given bus mutex, blocks while another thread holds it.
+ * @param   m mutex index, KM_*
+ * @retval  none
+ */
+void Kernel_Lock(uint8_t m) {
+  while (1) {
+    IRQ_BLOCK {
+      if ((kMutex[m] == KM_NOOWNER) || (kMutex[m] == kCur)) {
+        kMutex[m] = kCur;
+        return;
+      }
+      kTcb[kCur].wait = m;
+      kTcb[kCur].state = KSTATE_BLOCKED;
+    }
+    Kernel_Yield();
+  }
+}
+
+
+/**
+ * @brief   Releases the given bus mutex and wakes up the threads blocked on it.
+ * @param   m mutex index, KM_*
+ * @retval  none
+ */
+void Kernel_Unlock(uint8_t m) {
+  uint8_t preempt = 0;
+
+  IRQ_BLOCK {
+    if (kMutex[m] != kCur) return;
+    kMutex[m] = KM_NOOWNER;
+    for (uint8_t i = 0; i < KERNEL_THREADS; i++) {
+      if ((kTcb[i].state == KSTATE_BLOCKED) && (kTcb[i].wait == m)) {
+        kTcb[i].state = KSTATE_READY;
+        if (kTcb[i].prio > kTcb[kCur].prio) preempt = 1;
+      }
+    }
+  }
+  if (preempt) Kernel_Yield();
+}
+
+
+/**
+ * @brief   Checks the running thread in with the supervisor, once per
+ *          pass of its loop.
+ * @retval  none
+ */
+void Kernel_CheckIn(void) {
+  uint32_t now = Get_SysCnt();
+
+  IRQ_BLOCK {
+    kTcb[kCur].checkIn = now;
+  }
+}
+
+
+/**
+ * @brief   Checks every thread has checked in within its budget. The main
+ *          loop thread is left to the task supervisor. A thread has no
+ *          restart hook, an overdue one is reported straight away.
+ * @retval  (uint8_t) number of the overdue thread, 0 if all are healthy
+ */
+uint8_t Kernel_Supervise(void) {
+  uint32_t now = Get_SysCnt();
+
+  for (uint8_t i = 1; i < KERNEL_THREADS; i++) {
+    uint32_t in;
+    IRQ_BLOCK {
+      in = kTcb[i].checkIn;
+    }
+    if (TIME_ELAPSED(now, in) > pgm_read_word(&kThreads[i - 1].budget)) return i;
+  }
+  return 0;
+}
+
+
+/**
+ * @brief   Gives the running thread.
+ * @retval  (uint8_t) thread number, 0 is the main loop
+ */
+uint8_t Kernel_Running(void) {
+  return kCur;
+}
+
+#endif /* KERNEL_PREEMPT */
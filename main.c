@@ -13,16 +13,22 @@
 /* Private variables */
 static volatile uint8_t   _GREG_  = 0;
 static volatile uint8_t   _PREG_  = 0;
-static volatile uint16_t  sysCnt  = 0;
-static volatile uint16_t  secCnt  = 0;
+static volatile uint32_t  sysCnt  = 0;
+static volatile uint32_t  secCnt  = 0;
+static uint32_t           secMark = SEC_TICKS;
+static volatile systick_t sysTick = {1, 1, (uint8_t)(SYS_TICK_Q16 >> 16), (uint16_t)SYS_TICK_Q16, 0, 0};
+static idle_stat_t        idleStat;
 
 /* Private function definitions */
 static void Cron(void);
-static void SysTick_Handler(void);
-static void Second_Handler(void);
+static void SysTick_Handler(uint8_t);
+static void Idle(void);
+static void Init_SysTick(void);
 
 /* STDOUT definition */
-static FILE dsplout = FDEV_SETUP_STREAM(putc_dspl, NULL, _FDEV_SETUP_WRITE);
+#if !defined(HOST_BUILD)
+  static FILE dsplout = FDEV_SETUP_STREAM(putc_dspl, NULL, _FDEV_SETUP_WRITE);
+#endif
 
 
 
@@ -33,22 +39,37 @@ static FILE dsplout = FDEV_SETUP_STREAM(putc_dspl, NULL, _FDEV_SETUP_WRITE);
 int main(void) {
   /* Initialization block */
   cli();
+  uint8_t mcusr = MCUSR;
   _INIT_MCU;
   _INIT_WDG;
+  Init_Wdg(mcusr);
   _INIT_LED;
   _INIT_TIMERS;
+  Init_SysTick();
+#if defined(PIN_TRACE)
+  Init_PinTrace();
+#endif
+#if defined(EVENT_TRACE)
+  Init_Trace();
+#endif
   _INIT_I2C;
   Init_ISR();
+  Init_Scheduler();
   if (!Init_Display())  FLAG_SET(_PREG_, _DSPLRF_);
   if (!Init_OneWire()) FLAG_SET(_PREG_, _OWBUSRF_);
   if (!Init_DigitalDisplay()) FLAG_SET(_PREG_, _DIGDRF_);
+#if defined(KERNEL_PREEMPT)
+  Init_Kernel();
+#endif
   sei();
+  Init_BusStat();
 
   /* --- Init default standard output into display --- */
   stdout = Init_DsplOut();
 
   while (1) {
     Cron();
+    Idle();
   }
 
 }
@@ -56,67 +77,101 @@ int main(void) {
 
 /**
  * @brief   The application system cron service handler.
+ *          Drains a batch of events pushed by ISRs.
  * @retval  none
  */
 static void Cron(void) {
-  SysTick_Handler();
-  Second_Handler();
+  event_t ev;
+
+  for (uint8_t i = 0; (i < EVENT_BATCH) && (Event_Pop(&ev)); i++) {
+    switch (ev.type) {
+      case EV_TICK:
+        SysTick_Handler(ev.arg);
+        break;
+      default:
+        /* --- Counted by the ring, no handler yet --- */
+        break;
+    }
+  }
 }
 
 
 /**
- * @brief   The application system cron service handler.
+ * @brief   The application system tick event handler.
+ * @param   ticks number of ticks carried by the event
  * @retval  none
  */
-static void SysTick_Handler(void) {
-  /* Increase SysTick counter */
-  if (FLAG_CHECK(_GREG_, _SYSTF_)) {
-    cli();
-    FLAG_CLR(_GREG_, _SYSTF_);
-    sysCnt &= SEC_TICK_MASK;
-    
-    if (!sysCnt) {
-      secCnt++;
-      FLAG_SET(_GREG_, _SECTF_);
-    }
-    sei();
+static void SysTick_Handler(uint8_t ticks) {
+  uint32_t now = Get_SysCnt();
+
+  /* --- A tickless period may step over the second boundary --- */
+  while (TIME_REACHED(now, secMark)) {
+    secMark += SEC_TICKS;
+    secCnt++;
+    Wdg_Service();
+  }
 
-    /* --- Millis dependent services --- */
-    LedToggle_Scheduler();
-    PrintDigitalDisplay_Scheduler();
+  /* --- Dispatch periodic services from the task table --- */
+  idleStat.winTicks += ticks;
+  while (ticks--) {
+    Scheduler_Tick();
   }
 }
 
 
 /**
-* @brief   The application periodical event handler (secondly.)
-* @retval  none
-*/
-static void Second_Handler(void) {
-  if (FLAG_CHECK(_GREG_, _SECTF_)) {
-    FLAG_CLR(_GREG_, _SECTF_);
-    
-    /* --- Seconds dependent services --- */
-    Print_Scheduler();
-    GetTemperature_Scheduler();
+ * @brief   Puts the core into Idle sleep until the next Timer0 period ends.
+ *          The next period is stretched up to the nearest task deadline.
+ * @retval  none
+ */
+static void Idle(void) {
+  /* --- Raw cli(), the sleep below needs the SEI right before SLEEP --- */
+  cli();
+  if (Event_Pending()) {
+    sei();
+    return;
+  }
+
+  /* --- Ticks left to the deadline once the running period ends --- */
+  /* --- Kernel threads wake on any tick, so the tick is not stretched --- */
+  uint16_t due = Scheduler_NextDue();
+  uint8_t step = 1;
+#if defined(KERNEL_PREEMPT)
+  due = 0;
+#endif
+  if (due > sysTick.cur + 1) {
+    due -= sysTick.cur;
+    step = (due > IDLE_MAX_STEP) ? IDLE_MAX_STEP : due;
+  }
+  sysTick.next = step;
+
+  /* --- Time asleep in Timer0 counts, an I2C queue step may wake the core early --- */
+  uint16_t sleepAt = (uint16_t)Get_TimerCnt();
+
+  TRACE(TRACE_SLEEP, 0);
+  /* --- SEI holds off interrupts for one instruction, no wake-up is lost --- */
+  sei();
+  sleep_cpu();
+  idleStat.winSleep += (uint16_t)((uint16_t)Get_TimerCnt() - sleepAt);
+
+  /* --- Wake-up latency, Timer0 counts since the compare match clear --- */
+  if (Event_Pending()) {
+    TRACE(TRACE_WAKE, 0);
+    uint16_t lat = TCNT0 * IDLE_US_PER_CNT;
+    idleStat.wakeLatLast = lat;
+    if (lat > idleStat.wakeLatMax) idleStat.wakeLatMax = lat;
   }
 }
 
 
 /**
- * @brief   Simple millisecond-step delay.
- * @param   delay delay value in millis
- * @param   reg pointer to the control register
- * @param   flag control flag
+ * @brief   Applies the oscillator calibration stored in EEPROM to the tick rate.
  * @retval  none
  */
-void _delay_ms(uint16_t delay, volatile uint8_t* reg, uint8_t flag) {
-  FLAG_SET(*reg, flag);
-  uint16_t tmpDelay = (sysCnt + delay) & SEC_TICK_MASK;
-  while (tmpDelay != sysCnt) {
-    Cron();
-  }
-  FLAG_CLR(*reg, flag);
+static void Init_SysTick(void) {
+  int16_t ppm = 0;
+  EEPROM_ReadBuffer(EE_TICK_CAL, (uint8_t*)&ppm, sizeof(ppm));
+  Set_TickCal(ppm);
 }
 
 
@@ -129,17 +184,111 @@ volatile uint8_t* Get_PREG(void) {
   return &_PREG_;
 }
 
-volatile uint16_t* Get_SysCnt(void) {
+volatile uint32_t* Get_SysCntReg(void) {
   return &sysCnt;
 }
 
-volatile uint16_t Get_SecCnt(void) {
-  return secCnt;
+/**
+ * @brief   Reads the monotonic system tick counter, tear-free.
+ * @retval  (uint32_t) ticks (milliseconds) since start
+ */
+uint32_t Get_SysCnt(void) {
+  uint32_t cnt;
+  IRQ_BLOCK {
+    cnt = sysCnt;
+  }
+  return cnt;
+}
+
+/**
+ * @brief   Reads the monotonic seconds counter, tear-free.
+ * @retval  (uint32_t) seconds since start
+ */
+uint32_t Get_SecCnt(void) {
+  uint32_t cnt;
+  IRQ_BLOCK {
+    cnt = secCnt;
+  }
+  return cnt;
+}
+
+/**
+ * @brief   Reads Timer0 extended by the counts of its finished periods, a
+ *          clk/1024 clock that runs on across the tickless periods.
+ * @retval  (uint32_t) Timer0 counts since start
+ */
+uint32_t Get_TimerCnt(void) {
+  uint32_t base;
+  uint8_t cnt;
+
+  /* --- Plain atomic block, the measured ones take their time from here --- */
+  ATOMIC_BLOCK(ATOMIC_RESTORESTATE) {
+    cnt = TCNT0;
+    base = sysTick.counts;
+    /* --- The period has ended but the ISR has not counted it yet --- */
+    if (TIFR & _BV(OCF0A)) {
+      cnt = TCNT0;
+      base += (uint16_t)OCR0A + 1;
+    }
+  }
+  return base + cnt;
+}
+
+volatile systick_t* Get_SysTick(void) {
+  return &sysTick;
+}
+
+idle_stat_t* Get_IdleStat(void) {
+  return &idleStat;
+}
+
+/**
+ * @brief   Closes the idle statistics window.
+ * @retval  (uint8_t) percentage of time spent asleep since the previous call
+ */
+uint8_t Get_IdlePercent(void) {
+  if (idleStat.winTicks) {
+    idleStat.sleepPct = (uint8_t)((idleStat.winSleep * IDLE_US_PER_CNT) / (idleStat.winTicks * 10));
+  }
+  idleStat.winTicks = 0;
+  idleStat.winSleep = 0;
+  return idleStat.sleepPct;
 }
 
 FILE* Init_DsplOut(void) {
+#if defined(HOST_BUILD)
+  return Host_FdevOpen(putc_dspl);
+#else
   return &dsplout;
+#endif
 }
 
 
 /* Setters */
+
+/**
+ * @brief   Sets the system tick rate for the given oscillator error.
+ *          Erased EEPROM (-1) and out of range values fall back to nominal.
+ * @param   ppm oscillator frequency error, ppm, positive if running fast
+ * @retval  none
+ */
+void Set_TickCal(int16_t ppm) {
+  if ((ppm == -1) || (ppm > SYS_TICK_PPM) || (ppm < -SYS_TICK_PPM)) ppm = 0;
+  uint32_t q16 = SYS_TICK_Q16 + ((int32_t)(SYS_TICK_Q16 / 1000) * ppm) / 1000;
+
+  IRQ_BLOCK {
+    sysTick.whole = (uint8_t)(q16 >> 16);
+    sysTick.frac = (uint16_t)q16;
+  }
+}
+
+
+/**
+ * @brief   Stores the oscillator calibration into EEPROM and applies it.
+ * @param   ppm oscillator frequency error, ppm, positive if running fast
+ * @retval  none
+ */
+void Save_TickCal(int16_t ppm) {
+  EEPROM_WriteBuffer(EE_TICK_CAL, (uint8_t*)&ppm, sizeof(ppm));
+  Set_TickCal(ppm);
+}
@@ -0,0 +1,333 @@
+/*
+ * Filename: sched.c
+ * Description: The file contains the table-driven task scheduler.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 10:12:40 AM
+ * Author: Dmitry Slobodchikov
+ */ 
+
+#include "main.h"
+
+
+/* Task descriptor table, a new periodic task is to be added here */
+const sched_task_t schedTasks[] PROGMEM = {
+#if !defined(KERNEL_PREEMPT)
+  {LED_SRV_STEP,  LED_SRV_STEP,  2 * LED_SRV_STEP,  LedToggle_Scheduler,           NULL,                   SCHED_NORF},
+  {DIGD_SRV_STEP, DIGD_SRV_STEP, 2 * DIGD_SRV_STEP, PrintDigitalDisplay_Scheduler, NULL,                   _DIGDRF_},
+#endif
+  {PRNT_SRV_STEP, PRNT_SRV_STEP, 3 * PRNT_SRV_STEP, Print_Scheduler,               NULL,                   _DSPLRF_},
+  {TMPR_SRV_STEP, TMPR_SRV_STEP, 2 * TMPR_SRV_STEP, GetTemperature_Scheduler,      GetTemperature_Restart, _OWBUSRF_},
+#if defined(SCHED_PROFILE)
+  {PROF_SRV_STEP, PROF_SRV_STEP + (SEC_TICKS >> 1), 2 * PROF_SRV_STEP, PrintProfile_Scheduler, NULL,      _DSPLRF_}
+#endif
+#if defined(PIN_TRACE)
+  {PTRACE_SRV_STEP, PTRACE_SRV_STEP, 2 * PTRACE_SRV_STEP, PinTrace_Scheduler,      NULL,                   SCHED_NORF}
+#endif
+#if defined(EVENT_TRACE)
+  {TRACE_SRV_STEP, TRACE_SRV_STEP, 2 * TRACE_SRV_STEP,    Trace_Scheduler,         NULL,                   SCHED_NORF}
+#endif
+};
+
+#define SCHED_TASKS (sizeof(schedTasks) / sizeof(sched_task_t))
+
+
+/* Private variables */
+/* --- Delta queue: each node holds ticks remaining after its predecessor --- */
+static uint16_t schedDelta[SCHED_TASKS];
+static uint8_t  schedNext[SCHED_TASKS];
+static uint8_t  schedHead = SCHED_NIL;
+
+static uint16_t schedDefer = 1;
+static volatile uint8_t schedRunning = SCHED_NIL;
+
+/* --- Supervision: last check-in time and restart strike per task --- */
+static uint32_t schedCheckIn[SCHED_TASKS];
+static uint8_t  schedStrike[SCHED_TASKS];
+
+#if defined(SCHED_PROFILE)
+  static volatile uint16_t profOvf = 0;
+  static prof_stat_t profStat[SCHED_TASKS];
+#endif
+
+#if defined(STACK_PROFILE)
+  static uint16_t stackPeak[SCHED_TASKS];
+#endif
+
+/* Private function definitions */
+static void Scheduler_Insert(uint8_t, uint16_t);
+static uint8_t Scheduler_Dispatch(uint8_t);
+static uint8_t Scheduler_Run(uint8_t (*)(void), uint8_t);
+
+#if defined(SCHED_PROFILE)
+  static uint32_t Profile_Now(void);
+#endif
+
+
+
+/**
+ * @brief   Builds the delta queue from the task descriptor table.
+ * @retval  none
+ */
+void Init_Scheduler(void) {
+#if defined(SCHED_PROFILE)
+  _INIT_PROF;
+  Scheduler_ResetProfile();
+#endif
+  schedHead = SCHED_NIL;
+  for (uint8_t i = 0; i < SCHED_TASKS; i++) {
+    Scheduler_Insert(i, pgm_read_word(&schedTasks[i].phase));
+    schedCheckIn[i] = Get_SysCnt();
+  }
+}
+
+
+/**
+ * @brief   Inserts a task into the delta queue keeping it sorted.
+ * @param   task index of the task in the descriptor table
+ * @param   delay ticks until the task is due
+ * @retval  none
+ */
+static void Scheduler_Insert(uint8_t task, uint16_t delay) {
+  uint8_t prev = SCHED_NIL;
+  uint8_t curr = schedHead;
+
+  /* --- A task lands after all ones due at the same tick, FIFO order --- */
+  while ((curr != SCHED_NIL) && (schedDelta[curr] <= delay)) {
+    delay -= schedDelta[curr];
+    prev = curr;
+    curr = schedNext[curr];
+  }
+
+  schedDelta[task] = delay;
+  schedNext[task] = curr;
+  if (curr != SCHED_NIL) schedDelta[curr] -= delay;
+
+  if (prev == SCHED_NIL) {
+    schedHead = task;
+  } else {
+    schedNext[prev] = task;
+  }
+}
+
+
+/**
+ * @brief   Advances the delta queue by one tick and dispatches due tasks.
+ *          Only the head node is touched unless a task is due.
+ * @retval  none
+ */
+void Scheduler_Tick(void) {
+  if (schedHead == SCHED_NIL) return;
+  if (schedDelta[schedHead]) schedDelta[schedHead]--;
+
+  while ((schedHead != SCHED_NIL) && (!schedDelta[schedHead])) {
+    uint8_t task = schedHead;
+    const sched_task_t* desc = &schedTasks[task];
+    uint16_t delay = pgm_read_word(&desc->period);
+    schedHead = schedNext[task];
+
+    uint8_t status = 0;
+    uint8_t rflag = pgm_read_byte(&desc->rflag);
+    if ((rflag == SCHED_NORF) || (FLAG_CHECK(*Get_PREG(), rflag))) {
+      status = Scheduler_Dispatch(task);
+    }
+
+    if (status == PT_WAITING) {
+      /* --- A waiting coroutine resumes after the deferred delay --- */
+      delay = schedDefer;
+    } else {
+      /* --- A task checks in each time it completes, or is not ready to run --- */
+      schedCheckIn[task] = Get_SysCnt();
+      schedStrike[task] = 0;
+    }
+    schedDefer = 1;
+    Scheduler_Insert(task, delay);
+  }
+}
+
+
+/**
+ * @brief   Runs the task handler, measures it when profiling is on.
+ * @param   task index of the task in the descriptor table
+ * @retval  (uint8_t) status of the handler
+ */
+static uint8_t Scheduler_Dispatch(uint8_t task) {
+  uint8_t (*handler)(void) = (uint8_t (*)(void))pgm_read_ptr(&schedTasks[task].handler);
+  uint8_t status;
+
+  schedRunning = task;
+  TRACE(TRACE_TASK_IN, task);
+#if defined(STACK_PROFILE)
+  /* --- Stack depth reached by this dispatch only --- */
+  Stack_Rewind();
+  status = Scheduler_Run(handler, task);
+  uint16_t depth = Stack_Sample();
+  if (depth > stackPeak[task]) stackPeak[task] = depth;
+#else
+  status = Scheduler_Run(handler, task);
+#endif
+  TRACE(TRACE_TASK_OUT, task);
+  schedRunning = SCHED_NIL;
+
+  return status;
+}
+
+
+/**
+ * @brief   Calls the task handler, measures its runtime when profiling is on.
+ * @param   handler the task handler
+ * @param   task index of the task in the descriptor table
+ * @retval  (uint8_t) status of the handler
+ */
+static uint8_t Scheduler_Run(uint8_t (*handler)(void), uint8_t task) {
+#if defined(SCHED_PROFILE)
+  uint32_t ticks = Get_SysCnt();
+  uint32_t start = Profile_Now();
+  uint8_t status = handler();
+  uint32_t run = Profile_Now() - start;
+  ticks = TIME_ELAPSED(Get_SysCnt(), ticks);
+
+  prof_stat_t* stat = &profStat[task];
+  uint16_t run16 = (run > 0xffff) ? 0xffff : (uint16_t)run;
+  if (run16 < stat->min) stat->min = run16;
+  if (run16 > stat->max) stat->max = run16;
+  stat->sum += run;
+  stat->calls++;
+  stat->overruns += ticks;
+  return status;
+#else
+  (void)task;
+  return handler();
+#endif
+}
+
+
+/**
+ * @brief   Sets when a waiting coroutine task is to be resumed, the next tick
+ *          by default.
+ * @param   ticks delay in system ticks
+ * @retval  none
+ */
+void Scheduler_Defer(uint16_t ticks) {
+  schedDefer = ticks ? ticks : 1;
+}
+
+
+/**
+ * @brief   Gives the number of ticks until the next task is due.
+ * @retval  (uint16_t) ticks to the next deadline, 0xffff if the queue is empty
+ */
+uint16_t Scheduler_NextDue(void) {
+  if (schedHead == SCHED_NIL) return 0xffff;
+  return schedDelta[schedHead];
+}
+
+
+/**
+ * @brief   Checks every task has checked in within its budget. An overdue
+ *          task gets its driver restarted once; if it is still overdue a
+ *          budget later, or has no restart hook, it is reported. Called
+ *          from the main loop, so it only sees a task that keeps missing
+ *          its check-ins while the loop runs. A handler hung inside never
+ *          gets here; the watchdog is then not fed, and the timeout
+ *          interrupt blames the running task before the reset.
+ * @retval  (uint8_t) index of the task that needs an MCU reset, SCHED_NIL if healthy
+ */
+uint8_t Scheduler_Supervise(void) {
+  uint32_t now = Get_SysCnt();
+
+  for (uint8_t i = 0; i < SCHED_TASKS; i++) {
+    if (TIME_ELAPSED(now, schedCheckIn[i]) <= pgm_read_word(&schedTasks[i].budget)) continue;
+
+    uint8_t (*restart)(void) = (uint8_t (*)(void))pgm_read_ptr(&schedTasks[i].restart);
+    if ((schedStrike[i]) || (!restart)) return i;
+
+    schedStrike[i] = 1;
+    schedCheckIn[i] = now;
+    restart();
+  }
+  return SCHED_NIL;
+}
+
+
+/**
+ * @brief   Gives the number of tasks in the descriptor table.
+ * @retval  (uint8_t) number of tasks
+ */
+uint8_t Scheduler_TaskCount(void) {
+  return SCHED_TASKS;
+}
+
+
+/* Getters */
+volatile uint8_t* Get_SchedRunning(void) {
+  return &schedRunning;
+}
+
+
+#if defined(STACK_PROFILE)
+/**
+ * @brief   Gives the deepest stack usage seen while the given task ran.
+ * @param   task index of the task in the descriptor table
+ * @retval  (uint16_t) stack depth, bytes, 0 if no such task
+ */
+uint16_t Scheduler_GetStackPeak(uint8_t task) {
+  if (task >= SCHED_TASKS) return 0;
+  return stackPeak[task];
+}
+#endif
+
+
+#if defined(SCHED_PROFILE)
+
+/**
+ * @brief   Reads the Timer1 based counter extended by the overflow count.
+ * @retval  (uint32_t) Timer1 counts since start
+ */
+static uint32_t Profile_Now(void) {
+  uint8_t lo;
+  uint16_t hi;
+
+  IRQ_BLOCK {
+    lo = TCNT1;
+    hi = profOvf;
+    /* --- Overflow is pending but not yet counted by the ISR --- */
+    if ((TIFR & _BV(TOV1)) && (lo < 0x80)) hi++;
+  }
+  return ((uint32_t)hi << 8) | lo;
+}
+
+
+/**
+ * @brief   Gives the runtime statistics of the given task.
+ * @param   task index of the task in the descriptor table
+ * @retval  (const prof_stat_t*) pointer to the statistics, NULL if no such task
+ */
+const prof_stat_t* Scheduler_GetProfile(uint8_t task) {
+  if (task >= SCHED_TASKS) return NULL;
+  return &profStat[task];
+}
+
+
+/**
+ * @brief   Clears the runtime statistics of all tasks.
+ * @retval  none
+ */
+void Scheduler_ResetProfile(void) {
+  for (uint8_t i = 0; i < SCHED_TASKS; i++) {
+    profStat[i].min = 0xffff;
+    profStat[i].max = 0;
+    profStat[i].sum = 0;
+    profStat[i].calls = 0;
+    profStat[i].overruns = 0;
+  }
+}
+
+
+/* Getters */
+volatile uint16_t* Get_ProfOvf(void) {
+  return &profOvf;
+}
+
+#endif /* SCHED_PROFILE */
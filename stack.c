@@ -0,0 +1,133 @@
+/*
+ * Filename: stack.c
+ * Description: The file contains stack usage and RAM budget code.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 01:05:52 PM
+ * Author: Dmitry Slobodchikov
+ */ 
+
+#include "main.h"
+
+/* --- The host stack is not the AVR one, the report is AVR only --- */
+#if !defined(HOST_BUILD)
+
+/* Linker symbols */
+extern uint8_t _end;
+extern uint8_t __stack;
+extern uint8_t __data_start;
+
+/* Private variables */
+#if defined(STACK_PROFILE)
+  static uint16_t stackPeak = 0; // deepest stack before the last repaint
+#endif
+
+/* Private function definitions */
+void Stack_Paint(void) __attribute__((naked, used, section(".init1")));
+static uint8_t* Stack_Lowest(void);
+
+
+
+/**
+ * @brief   Paints RAM from the end of .bss up to the top of the stack with
+ *          the canary pattern. Runs from .init1, before the stack pointer
+ *          and r1 are set up, hence assembly only.
+ * @retval  none
+ */
+void Stack_Paint(void) {
+  __asm__ __volatile__ (
+    "    ldi r30, lo8(_end)     \n"
+    "    ldi r31, hi8(_end)     \n"
+    "    ldi r24, %0            \n"
+    "    ldi r25, hi8(__stack)  \n"
+    "    rjmp 2f                \n"
+    "1:  st Z+, r24             \n"
+    "2:  cpi r30, lo8(__stack)  \n"
+    "    cpc r31, r25           \n"
+    "    brlo 1b                \n"
+    "    breq 1b                \n"
+    :: "M" (STACK_CANARY)
+  );
+}
+
+
+/**
+ * @brief   Finds the lowest RAM address the stack has ever touched.
+ * @retval  (uint8_t*) the lowest used address
+ */
+static uint8_t* Stack_Lowest(void) {
+  uint8_t* p = &_end;
+  while ((p <= &__stack) && (*p == STACK_CANARY)) p++;
+  return p;
+}
+
+
+/**
+ * @brief   Gives the stack high-water mark.
+ * @retval  (uint16_t) deepest stack usage since start, bytes
+ */
+uint16_t Stack_HighWater(void) {
+  uint16_t depth = (uint16_t)(&__stack - Stack_Lowest()) + 1;
+#if defined(STACK_PROFILE)
+  if (stackPeak > depth) depth = stackPeak;
+#endif
+  return depth;
+}
+
+
+/**
+ * @brief   Gives the RAM never touched between .bss and the stack.
+ * @retval  (uint16_t) remaining headroom, bytes
+ */
+uint16_t Stack_Headroom(void) {
+  return (uint16_t)(Stack_Lowest() - &_end);
+}
+
+
+/**
+ * @brief   Fills up the RAM budget report.
+ * @param   rep pointer to the report
+ * @retval  none
+ */
+void Stack_Report(stack_report_t* rep) {
+  uint8_t* low = Stack_Lowest();
+
+  rep->total = (uint16_t)(&__stack - &__data_start) + 1;
+  rep->static_ = (uint16_t)(&_end - &__data_start);
+  rep->highWater = Stack_HighWater();
+  rep->headroom = (uint16_t)(low - &_end);
+}
+
+
+#if defined(STACK_PROFILE)
+
+/**
+ * @brief   Repaints the RAM below the current stack frame, so the next
+ *          sample sees only what has been used since.
+ * @retval  none
+ */
+void Stack_Rewind(void) {
+  uint8_t* p = Stack_Lowest();
+  uint16_t depth = (uint16_t)(&__stack - p) + 1;
+  if (depth > stackPeak) stackPeak = depth;
+
+  /* --- ISRs push below SP, keep them out while repainting --- */
+  IRQ_BLOCK {
+    uint8_t* sp = (uint8_t*)SP;
+    while (p < sp) *p++ = STACK_CANARY;
+  }
+}
+
+
+/**
+ * @brief   Gives the stack depth reached since the last Stack_Rewind().
+ * @retval  (uint16_t) stack depth, bytes
+ */
+uint16_t Stack_Sample(void) {
+  return (uint16_t)(&__stack - Stack_Lowest()) + 1;
+}
+
+#endif /* STACK_PROFILE */
+
+#endif /* HOST_BUILD */
@@ -0,0 +1,121 @@
+/*
+ * Filename: trace.c
+ * Description: The file contains the binary event trace. Events go into a
+ *              RAM ring with Timer1 time, a dispatch over TRACE_LONG_US or
+ *              a Trace_Freeze() call stops it for an EEPROM dump.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 11:20:48 AM
+ * Author: Dmitry Slobodchikov
+ */
+
+#include "main.h"
+
+#if defined(EVENT_TRACE)
+
+#define TRACE_LONG_CNT  (TRACE_LONG_US / IDLE_US_PER_CNT)
+
+/* Private variables */
+static volatile trace_ev_t ring[TRACE_SIZE];
+static volatile uint8_t head   = 0;   // next slot
+static volatile uint8_t count  = 0;   // events kept
+static volatile uint8_t frozen = 0;
+static uint16_t    inAt   = 0;        // Timer0 at the last dispatch
+static trace_hdr_t hdr;
+static uint8_t     stored = 0;        // the ring is in EEPROM
+static uint8_t     dumped = 0;        // events written to EEPROM
+
+
+
+/**
+ * @brief   Starts Timer1 in step with Timer0. A ring already in EEPROM is
+ *          kept until the EEPROM is erased, the trace stays off then.
+ * @retval  none
+ */
+void Init_Trace(void) {
+  uint8_t magic = 0;
+
+  _INIT_TRACE;
+  /* --- Both prescalers restart together, Timer1 takes the Timer0 parity --- */
+  GTCCR = _BV(TSM)|_BV(PSR0)|_BV(PSR1);
+  TCNT1 = (Get_TimerCnt() & 1) ? 0x80 : 0;
+  GTCCR = 0;
+
+  EEPROM_ReadBuffer(EE_TRACE_ADDR, &magic, 1);
+  if (magic == TRACE_MAGIC) {
+    frozen = 1;
+    stored = 1;
+  }
+}
+
+
+/**
+ * @brief   Records an event. Timer1 is read before Timer0, the decoder
+ *          relies on the order.
+ * @param   id event type and argument
+ * @retval  none
+ */
+void Trace_Event(uint8_t id) {
+  IRQ_BLOCK {
+    uint8_t t1 = TCNT1;
+    uint16_t t0 = (uint16_t)Get_TimerCnt();
+
+    if (!frozen) {
+      volatile trace_ev_t* ev = &ring[head];
+      ev->id = id;
+      ev->t1 = t1;
+      ev->t0 = t0;
+      if (++head >= TRACE_SIZE) head = 0;
+      if (count < TRACE_SIZE) count++;
+
+      if (TRACE_TYPE(id) == TRACE_TASK_IN) {
+        inAt = t0;
+      } else if ((TRACE_TYPE(id) == TRACE_TASK_OUT) && ((uint16_t)(t0 - inAt) > TRACE_LONG_CNT)) {
+        hdr.task = TRACE_ARG(id);
+        Trace_Freeze(TRACE_WHY_LONG);
+      }
+    }
+  }
+}
+
+
+/**
+ * @brief   Stops the trace, the ring keeps the events up to here.
+ * @param   why freeze reason
+ * @retval  none
+ */
+void Trace_Freeze(uint8_t why) {
+  if (frozen) return;
+  frozen = 1;
+  hdr.magic = TRACE_MAGIC;
+  hdr.count = count;
+  hdr.why = why;
+}
+
+
+/**
+ * @brief   Writes a frozen ring into EEPROM oldest event first, a chunk per
+ *          call, and the header last, so a dump cut by a reset is not taken
+ *          as valid.
+ * @retval  (uint8_t) status of operation
+ */
+uint8_t Trace_Scheduler(void) {
+  if (!frozen || stored) return 0;
+
+  if (dumped < hdr.count) {
+    uint8_t first = (head + TRACE_SIZE - hdr.count) % TRACE_SIZE;
+    for (uint8_t i = 0; (i < TRACE_DUMP_CHUNK / sizeof(trace_ev_t)) && (dumped < hdr.count); i++) {
+      uint8_t idx = (first + dumped) % TRACE_SIZE;
+      EEPROM_WriteBuffer(EE_TRACE_ADDR + sizeof(trace_hdr_t) + dumped * sizeof(trace_ev_t),
+                         (uint8_t*)&ring[idx], sizeof(trace_ev_t));
+      dumped++;
+    }
+    return 0;
+  }
+  EEPROM_WriteBuffer(EE_TRACE_ADDR, (uint8_t*)&hdr, sizeof(trace_hdr_t));
+  stored = 1;
+  return 0;
+}
+
+#endif /* EVENT_TRACE */
@@ -10,12 +10,21 @@
 
 #include "main.h"
 
+/* Private variables */
+static uint16_t delayUs = 0; // microseconds spent in _delay_us, wraps
+
+
 
 /**
  * @brief   Simple microsecond-step delay.
  * @retval  none
  */
 void _delay_us(uint16_t delay) {
+  delayUs += delay;
+#if defined(HOST_BUILD)
+  /* --- Same cycles as the NOP loop, taken in one go --- */
+  Host_Spin((uint32_t)delay * 8 * HOST_NOP_CYCLES);
+#else
   while (delay) {
     _NOP;
     _NOP;
@@ -27,6 +36,7 @@ void _delay_us(uint16_t delay) {
     _NOP;
     delay--;
   }
+#endif
 }
 
 
@@ -42,4 +52,10 @@ uint8_t cmpBBufs(uint8_t* buf1, uint8_t* buf2, uint16_t len) {
     if (buf1[i] != buf2[i]) return 1;
   }
   return 0;
-}
\ No newline at end of file
+}
+
+
+/* Getters */
+uint16_t Get_DelayUs(void) {
+  return delayUs;
+}
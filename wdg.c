@@ -0,0 +1,98 @@
+/*
+ * Filename: wdg.c
+ * Description: The file contains the task watchdog supervisor.
+ *
+ * Project: Simple Multitasking Logic
+ * Platform: MicroChip ATTiny85
+ * Created: 17.10.2026 04:47:31 PM
+ * Author: Dmitry Slobodchikov
+ */ 
+
+#include "main.h"
+
+/* Private variables */
+static volatile wdg_pm_t wdgPm __attribute__((section(".noinit")));
+static uint8_t lastCulprit = WDG_NONE;
+static uint8_t wdgStarve = 0;
+
+
+
+/**
+ * @brief   Picks up the post-mortem record of a watchdog reset.
+ * @param   mcusr MCUSR value captured before the watchdog was initialized
+ * @retval  none
+ */
+void Init_Wdg(uint8_t mcusr) {
+  if ((wdgPm.magic != WDG_MAGIC) || (mcusr & _BV(PORF))) {
+    wdgPm.magic = WDG_MAGIC;
+    wdgPm.resets = 0;
+    wdgPm.culprit = WDG_NONE;
+  }
+
+  if (mcusr & _BV(WDRF)) {
+    wdgPm.resets++;
+    lastCulprit = wdgPm.culprit;
+  }
+  wdgPm.culprit = WDG_NONE;
+}
+
+
+/**
+ * @brief   Feeds the watchdog only while every task, and with the kernel
+ *          every thread, is healthy. Otherwise blames it and starves the
+ *          watchdog, the first timeout interrupt is followed by the MCU
+ *          reset. A restart is only tried for missed task check-ins seen
+ *          here, a hung handler stops the main loop and goes to the reset
+ *          straight away.
+ * @retval  none
+ */
+void Wdg_Service(void) {
+  if (wdgStarve) return;
+
+  uint8_t task = Scheduler_Supervise();
+#if defined(KERNEL_PREEMPT)
+  if (task == SCHED_NIL) {
+    uint8_t thread = Kernel_Supervise();
+    if (thread) task = WDG_THREAD | thread;
+  }
+#endif
+  if (task == SCHED_NIL) {
+    wdt_reset();
+    /* --- The hardware clears WDIE on a timeout interrupt, re-arm it after a recovered stall --- */
+    IRQ_BLOCK {
+      if (!(WDTCR & _BV(WDIE))) {
+        WDTCR |= _BV(WDIE);
+        wdgPm.culprit = WDG_NONE;
+      }
+    }
+    return;
+  }
+  wdgPm.culprit = task;
+  wdgStarve = 1;
+}
+
+
+/**
+ * @brief   Gives the task blamed for the last watchdog reset.
+ * @retval  (uint8_t) task index, WDG_THREAD | thread number for a
+ *          kernel thread, WDG_IDLE if no task was running, WDG_NONE if
+ *          the last reset was not by watchdog
+ */
+uint8_t Wdg_LastCulprit(void) {
+  return lastCulprit;
+}
+
+
+/**
+ * @brief   Gives the number of watchdog resets since power-on.
+ * @retval  (uint8_t) reset counter
+ */
+uint8_t Wdg_Resets(void) {
+  return wdgPm.resets;
+}
+
+
+/* Getters */
+volatile wdg_pm_t* Get_WdgPm(void) {
+  return &wdgPm;
+}